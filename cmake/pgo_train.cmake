@@ -0,0 +1,115 @@
+# cmake/pgo_train.cmake
+# PGO 训练负载：覆盖编码 / 解码的主要路径（默认 16-FSK、压缩、子带、定点、自适应速率、
+# 重采样、长录音扫描、多帧随机访问、短报文咬尾码、流水线解码、盲参数识别、多发送端单遍解码），
+# 用 -fprofile-generate 构建的 audio_codec 跑一遍采集 profile。
+#
+#   cmake -DEXE=<audio_codec> -DWORK_DIR=<dir> -DPROFILE_DIR=<dir> -DCOMPILER_ID=<GNU|Clang>
+#         -P cmake/pgo_train.cmake
+
+foreach (var EXE WORK_DIR PROFILE_DIR COMPILER_ID)
+    if (NOT DEFINED ${var})
+        message(FATAL_ERROR "pgo_train.cmake: ${var} is not set")
+    endif()
+endforeach()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+# 训练数据：一段可压缩的文本 + 一段随机字符（LZ 基本压不动）
+set(text "")
+foreach (i RANGE 200)
+    string(APPEND text "line ${i}: status=OK latency=${i}ms payload=telemetry sample\n")
+endforeach()
+file(WRITE "${WORK_DIR}/text.bin" "${text}")
+string(RANDOM LENGTH 6000 RANDOM_SEED 1 noise)
+file(WRITE "${WORK_DIR}/random.bin" "${noise}")
+string(SUBSTRING "${text}" 0 40 short)
+file(WRITE "${WORK_DIR}/short.bin" "${short}")
+
+function(run)
+    execute_process(COMMAND "${EXE}" ${ARGN}
+                    WORKING_DIRECTORY "${WORK_DIR}"
+                    RESULT_VARIABLE rc
+                    OUTPUT_QUIET)
+    if (NOT rc EQUAL 0)
+        string(REPLACE ";" " " cmd "${ARGN}")
+        message(FATAL_ERROR "PGO training step failed (${rc}): audio_codec ${cmd}")
+    endif()
+endfunction()
+
+# 默认参数
+run(encode -i random.bin -o a.wav)
+run(decode -i a.wav -o a.out)
+run(decode -i a.wav -o a.q15 --fixed-point)
+
+# 压缩
+run(encode -i text.bin -o c.wav --compress)
+run(decode -i c.wav -o c.out)
+
+# 并行子带
+run(encode -i random.bin -o s.wav --subbands 4 --symdur 0.004)
+run(decode -i s.wav -o s.out --subbands 4 --symdur 0.004)
+
+# 自适应速率
+run(probe -i a.wav)
+run(encode -i random.bin -o r.wav --rate-mode 2)
+run(decode -i r.wav -o r.out --adaptive)
+
+# 重采样：48 kHz 录音按 44.1 kHz 参数解码（10 ms 符号在两种采样率下都是整数点）
+run(encode -i random.bin -o h.wav --sr 48000 --symdur 0.01)
+run(decode -i h.wav -o h.out --sr 44100 --symdur 0.01)
+
+# 长录音扫描
+run(scan -i a.wav)
+
+# 多帧流：边车索引 + 按字节区间随机解码，以及无索引时的帧头扫描
+run(encode -i text.bin -o f.wav --compress --frame-size 1024 --index f.idx)
+run(decode -i f.wav -o f.out)
+run(decode -i f.wav -o f.part --range 3000:5000 --index f.idx)
+run(index -i f.wav -o f2.idx)
+
+# 流水线解码（多帧流边解边写）
+run(decode -i f.wav -o p.out --pipeline)
+
+# 短报文：短前导 + 咬尾码
+run(encode -i short.bin -o t.wav --short)
+run(decode -i t.wav -o t.out --short)
+
+# 盲参数识别：不给任何参数，从前导测出后直接解码
+run(analyze -i h.wav -o z.out)
+
+# 多发送端单遍解码：同一组 bin 列两路，共享频谱中只算一次
+file(WRITE "${WORK_DIR}/streams.txt" "m.out --subbands 4\nn.out --subbands 4\n")
+run(decode-multi -i s.wav --streams streams.txt --symdur 0.004)
+
+foreach (name a c s r h f t p z m n)
+    if (name STREQUAL "c" OR name STREQUAL "f" OR name STREQUAL "p")
+        set(ref text.bin)
+    elseif (name STREQUAL "t")
+        set(ref short.bin)
+    else()
+        set(ref random.bin)
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files
+                            "${WORK_DIR}/${ref}" "${WORK_DIR}/${name}.out"
+                    RESULT_VARIABLE diff)
+    if (NOT diff EQUAL 0)
+        message(FATAL_ERROR "PGO training round trip mismatch: ${name}.out")
+    endif()
+endforeach()
+
+# Clang 的原始 profile 需要合并成 default.profdata 才能给 -fprofile-use 使用
+if (COMPILER_ID MATCHES "Clang")
+    find_program(LLVM_PROFDATA NAMES llvm-profdata)
+    if (NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "llvm-profdata not found, cannot merge Clang profiles")
+    endif()
+    file(GLOB raw "${PROFILE_DIR}/*.profraw")
+    execute_process(COMMAND "${LLVM_PROFDATA}" merge -output=${PROFILE_DIR}/default.profdata ${raw}
+                    RESULT_VARIABLE rc)
+    if (NOT rc EQUAL 0)
+        message(FATAL_ERROR "llvm-profdata merge failed")
+    endif()
+endif()
+
+message(STATUS "PGO profiles written to ${PROFILE_DIR}")
@@ -0,0 +1,531 @@
+// src/analyzer.cpp
+#include "analyzer.h"
+#include "wav_io.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+constexpr size_t ONSET_BLOCK       = 16;    // 起点检测的块长（样本）
+constexpr double ONSET_FRACTION    = 0.1;   // 起点门限：噪声底 + (最强块 - 噪声底) 的 10%
+constexpr size_t MIN_LAG           = 8;     // 最短周期 2N（N >= 4）
+constexpr double MIN_PERIOD_SCORE  = 0.5;   // 候选周期的归一化自相关下限
+constexpr double CANDIDATE_RATIO   = 0.8;   // 候选周期的相关不低于最大值的比例
+constexpr size_t MAX_CANDIDATES    = 16;    // 最多尝试的候选周期数
+constexpr size_t AVERAGE_PERIODS   = 6;     // 谱线与定时在几个周期（2N）上平均（录音够长时）
+constexpr double LINE_FRACTION     = 0.2;   // 前导谱线门限（相对最强谱线）
+constexpr double SYMBOL_ON_RATIO   = 0.25;  // 符号窗口“有信号”：谱线能量不低于第一个前导符号的比例
+constexpr int    HEAD_SYMBOLS      = 4;     // 前导开头按严格比例检查的符号数
+constexpr double HEAD_RATIO        = 8.0;   // 开头几个符号中应发的一组谱线至少是另一组的倍数
+                                            // （3N 的错误周期下两组为 4:1，不能通过）
+constexpr double COUNT_RATIO       = 2.0;   // 之后数前导长度时的比例（噪声下单个符号的波动）
+constexpr double TIMING_TIE        = 1e-9;  // 相邻两个定时相位的对比度相对差在此以内算打平
+
+// 单个频点（每样本 cyclesPerSample 周）的 Goertzel 能量，双精度：分析只在少数窗口上做
+double goertzelPower(const float* x, size_t n, double cyclesPerSample) {
+    const double c = 2.0 * std::cos(2.0 * PI * cyclesPerSample);
+    double s1 = 0.0;
+    double s2 = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const double s0 = x[i] + c * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return s1 * s1 + s2 * s2 - c * s1 * s2;
+}
+
+// N 点窗口上一组 bin 的能量之和
+double linesPower(const float* x, uint32_t N, const std::vector<int>& bins) {
+    double sum = 0.0;
+    for (int b : bins) {
+        sum += goertzelPower(x, N, static_cast<double>(b) / N);
+    }
+    return sum;
+}
+
+// 读入开头最多 maxSeconds 秒并去直流；complete：整个文件都已读入（之后没有更多样本）
+bool loadHead(const std::string& path, const DecodeParams& hints, double maxSeconds,
+              std::vector<float>& x, uint32_t& sampleRate, bool& complete) {
+    WavReader reader;
+    if (!(hints.rawPcm ? reader.openRawPcm16(path, hints.sampleRate) : reader.open(path))) {
+        return false;
+    }
+    const WavInfo& info = reader.info();
+    sampleRate = info.sampleRate;
+    uint64_t limit = static_cast<uint64_t>(maxSeconds * sampleRate);
+    if (info.sizeKnown) {
+        limit = std::min(limit, info.numFrames);
+    }
+
+    x.clear();
+    constexpr size_t CHUNK = 1 << 16;
+    while (x.size() < limit) {
+        const size_t want = static_cast<size_t>(std::min<uint64_t>(CHUNK, limit - x.size()));
+        const size_t old = x.size();
+        x.resize(old + want);
+        const size_t got = reader.read(x.data() + old, want);
+        x.resize(old + got);
+        if (got < want) break;
+    }
+    complete = x.size() < limit || (info.sizeKnown && x.size() == info.numFrames);
+    if (x.empty()) {
+        std::cerr << "No samples in " << path << "\n";
+        return false;
+    }
+
+    double mean = 0.0;
+    for (float v : x) mean += v;
+    mean /= static_cast<double>(x.size());
+    for (float& v : x) v = static_cast<float>(v - mean);
+    return true;
+}
+
+// 1. 第一个能量高于门限的块；噪声底取块能量的 10% 分位数
+bool findOnset(const std::vector<float>& x, size_t& onset) {
+    const size_t blocks = x.size() / ONSET_BLOCK;
+    if (blocks < 2) {
+        return false;
+    }
+    std::vector<double> energy(blocks);
+    for (size_t j = 0; j < blocks; ++j) {
+        double e = 0.0;
+        for (size_t i = 0; i < ONSET_BLOCK; ++i) {
+            const double v = x[j * ONSET_BLOCK + i];
+            e += v * v;
+        }
+        energy[j] = e;
+    }
+    std::vector<double> sorted(energy);
+    std::nth_element(sorted.begin(), sorted.begin() + blocks / 10, sorted.end());
+    const double floor = sorted[blocks / 10];
+    const double peak = *std::max_element(energy.begin(), energy.end());
+    if (peak <= 0.0) {
+        return false;
+    }
+    const double threshold = floor + (peak - floor) * ONSET_FRACTION;
+    for (size_t j = 0; j < blocks; ++j) {
+        if (energy[j] > threshold) {
+            onset = j * ONSET_BLOCK;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 2. 候选周期 2N：[s, s+2τ) 与 [s+τ, s+3τ) 的归一化相关，只试偶数 τ。
+//    2N 的整数倍处相关与 2N 处相当（噪声下难分高下）；窗口短于一个符号时，两音公共周期的
+//    整数倍处相关同样接近 1（窗口只落在一个音里）。所以这里只给出接近最大值的局部极大，
+//    按周期从短到长排列，由前导结构检查（fitPreamble）挑出第一个真正的 2N
+std::vector<size_t> findPeriodCandidates(const std::vector<float>& x, size_t s, size_t maxLag,
+                                         std::vector<double>& r) {
+    std::vector<double> energy(x.size() + 1, 0.0);   // 平方前缀和
+    for (size_t i = 0; i < x.size(); ++i) {
+        energy[i + 1] = energy[i] + static_cast<double>(x[i]) * x[i];
+    }
+
+    r.assign(maxLag + 3, -1.0);
+    for (size_t lag = MIN_LAG; lag <= maxLag; lag += 2) {
+        const size_t w = 2 * lag;
+        if (s + w + lag > x.size()) break;
+        double dot = 0.0;
+        const float* a = x.data() + s;
+        const float* b = a + lag;
+        for (size_t i = 0; i < w; ++i) {
+            dot += static_cast<double>(a[i]) * b[i];
+        }
+        const double ea = energy[s + w] - energy[s];
+        const double eb = energy[s + lag + w] - energy[s + lag];
+        r[lag] = dot / (std::sqrt(ea * eb) + 1e-12);
+    }
+
+    std::vector<size_t> peaks;
+    double best = MIN_PERIOD_SCORE;
+    for (size_t lag = MIN_LAG; lag <= maxLag; lag += 2) {
+        if (r[lag] >= MIN_PERIOD_SCORE && r[lag] >= r[lag - 2] && r[lag] > r[lag + 2]) {
+            peaks.push_back(lag);
+            best = std::max(best, r[lag]);
+        }
+    }
+    std::vector<size_t> candidates;
+    for (size_t lag : peaks) {
+        if (r[lag] >= CANDIDATE_RATIO * best && candidates.size() < MAX_CANDIDATES) {
+            candidates.push_back(lag);
+        }
+    }
+    return candidates;
+}
+
+// 3. 恰好一个周期的 DFT：每个前导音只占 2N 点中连续的 N 点（循环意义下），
+//    在偶数下标 2b（即 N 点 bin b）上对其余 bin 没有泄漏，谱线干净。periods 个周期的能量取平均
+std::vector<int> findPreambleLines(const std::vector<float>& x, size_t s, uint32_t N, size_t periods) {
+    const size_t span = 2 * static_cast<size_t>(N);
+    std::vector<double> power(N / 2, 0.0);
+    double peak = 0.0;
+    for (uint32_t b = 1; b < N / 2; ++b) {
+        for (size_t j = 0; j < periods; ++j) {
+            power[b] += goertzelPower(x.data() + s + j * span, span, static_cast<double>(b) / N);
+        }
+        peak = std::max(peak, power[b]);
+    }
+    std::vector<int> lines;
+    for (uint32_t b = 1; b < N / 2; ++b) {
+        if (peak > 0.0 && power[b] >= LINE_FRACTION * peak) {
+            lines.push_back(static_cast<int>(b));
+        }
+    }
+    return lines;
+}
+
+// 4. 符号定时：谱线上的滑动 DFT，覆盖一整个周期 2N 的所有相位。
+//    每条谱线的能量在窗口与“自己的”符号对齐时最大，同一组（tone0 或 tone15）的谱线峰值相位相同，
+//    两组相差 N，据此分组。再按 scanner 的做法用两组之差对窗内能量归一化的对比度找边界：
+//    子带相邻时（上一子带的 tone15 与下一子带的 tone0 只差一个 bin）错位窗口的泄漏会抬高单条谱线，
+//    只看谱线本身定时偏差很大，按窗内能量归一化后对比度约为 1 - 2d/N
+//    periods 个周期按相位（模 2N）累加；需要 x 至少有 s + (2 * periods + 1) * N 个样本
+size_t findSymbolTiming(const std::vector<float>& x, size_t s, uint32_t N, size_t periods,
+                        const std::vector<int>& lines, std::vector<int>& groupA, std::vector<int>& groupB) {
+    using cd = std::complex<double>;
+    const size_t L = lines.size();
+    const size_t span = 2 * static_cast<size_t>(N);
+    std::vector<cd> X(L);
+    std::vector<cd> rot(L);
+    for (size_t l = 0; l < L; ++l) {
+        const double w = 2.0 * PI * lines[l] / N;
+        rot[l] = std::polar(1.0, w);
+        cd acc = 0.0;
+        for (uint32_t m = 0; m < N; ++m) {
+            acc += static_cast<double>(x[s + m]) * std::polar(1.0, -w * m);
+        }
+        X[l] = acc;
+    }
+    double energy = 0.0;
+    for (uint32_t m = 0; m < N; ++m) {
+        energy += static_cast<double>(x[s + m]) * x[s + m];
+    }
+
+    std::vector<double> power(L * span, 0.0);     // power[l * span + (φ - s) % 2N]
+    std::vector<double> windowEnergy(span, 0.0);
+    for (size_t i = 0; i < span * periods; ++i) {
+        const size_t phi = s + i;
+        const size_t phase = i % span;
+        for (size_t l = 0; l < L; ++l) {
+            power[l * span + phase] += std::norm(X[l]);
+        }
+        windowEnergy[phase] += energy;
+        // X_{φ+1}(b) = e^{j2πb/N} (X_φ(b) - x[φ] + x[φ+N])
+        const double out = x[phi];
+        const double in = x[phi + N];
+        for (size_t l = 0; l < L; ++l) {
+            X[l] = rot[l] * (X[l] - out + in);
+        }
+        energy += in * in - out * out;
+    }
+
+    // 分组：与第 0 条谱线的峰值相位（模 2N）相差不到 N/2 的为同一组
+    std::vector<size_t> peakPhase(L);
+    for (size_t l = 0; l < L; ++l) {
+        const double* p = power.data() + l * span;
+        peakPhase[l] = static_cast<size_t>(std::max_element(p, p + span) - p);
+    }
+    groupA.clear();
+    groupB.clear();
+    std::vector<bool> inA(L);
+    for (size_t l = 0; l < L; ++l) {
+        const size_t d = (peakPhase[l] + span - peakPhase[0]) % span;
+        inA[l] = std::min(d, span - d) < N / 2;
+        (inA[l] ? groupA : groupB).push_back(lines[l]);
+    }
+
+    // 相位 i 与 i + N 的窗口分别对齐两组符号，两者的对比度一起计入
+    auto contrast = [&](size_t i) {
+        double diff = 0.0;
+        for (size_t l = 0; l < L; ++l) {
+            diff += inA[l] ? power[l * span + i] : -power[l * span + i];
+        }
+        return std::fabs(diff) / (windowEnergy[i] * N / 2.0 + 1e-12);
+    };
+    auto score = [&](size_t i) { return contrast(i % N) + contrast(i % N + N); };
+    size_t best = 0;
+    double bestScore = -1.0;
+    for (size_t i = 0; i < N; ++i) {
+        if (score(i) > bestScore) {
+            bestScore = score(i);
+            best = i;
+        }
+    }
+    // 每个符号从 sin(0) = 0 开始：晚一个样本的窗口只是把这个 0 换成下一符号开头的 0，对比度与
+    // 对齐的窗口完全相同，取哪个只看舍入误差（实测多半落在晚一个样本上）。打平时取早的那个；
+    // 早一个样本的窗口混入上一符号的末样本，对比度会低一点，不会被误判为打平
+    const size_t prev = (best + N - 1) % N;
+    if (score(prev) >= bestScore * (1.0 - TIMING_TIE)) {
+        best = prev;
+    }
+    return s + best;
+}
+
+// 一个候选 N 下找到的前导结构
+struct PreambleFit {
+    size_t           start = 0;     // 第一个前导符号
+    int              sync  = 0;     // 交替的符号数
+    std::vector<int> tone0;         // 各子带 tone0 的 bin（从低到高）
+    std::vector<int> tone15;
+    int              stride = 0;
+    double           ref    = 0.0;  // 一个前导符号在谱线上的能量
+};
+
+// 3..4. 谱线、定时、起点、tone0 / tone15 分组、前导长度；结构不符时给出原因并返回 false
+bool fitPreamble(const std::vector<float>& x, size_t s0, uint32_t N, PreambleFit& fit, std::string& why) {
+    fit = PreambleFit{};
+    if (s0 + 3 * static_cast<size_t>(N) > x.size()) {
+        why = "recording too short for N = " + std::to_string(N);
+        return false;
+    }
+    const size_t periods = std::min(AVERAGE_PERIODS, (x.size() - s0 - N) / (2 * static_cast<size_t>(N)));
+    const std::vector<int> lines = findPreambleLines(x, s0, N, periods);
+    if (lines.size() < 2 || lines.size() % 2 != 0 || lines.size() > 32) {
+        why = std::to_string(lines.size()) + " tone lines at N = " + std::to_string(N);
+        return false;
+    }
+
+    // 符号定时，再按整符号向前回溯到第一个有信号的前导符号
+    std::vector<int> groupA;
+    std::vector<int> groupB;
+    size_t start = findSymbolTiming(x, s0, N, periods, lines, groupA, groupB);
+    fit.ref = linesPower(x.data() + start, N, lines);
+    while (start >= N && linesPower(x.data() + start - N, N, lines) >= SYMBOL_ON_RATIO * fit.ref) {
+        start -= N;
+    }
+    fit.start = start;
+
+    // 第一个前导符号是 tone0：该窗口内占优的一组为各子带 tone0
+    const bool aFirst = linesPower(x.data() + start, N, groupA) >= linesPower(x.data() + start, N, groupB);
+    fit.tone0 = aFirst ? groupA : groupB;
+    fit.tone15 = aFirst ? groupB : groupA;
+    const size_t K = fit.tone0.size();
+    if (fit.tone15.size() != K) {
+        why = "lines at N = " + std::to_string(N) + " do not split into tone 0 / tone 15 pairs";
+        return false;
+    }
+    if (K > 1) {
+        // 子带按频率从低到高（子带间隔为正）
+        fit.stride = fit.tone0[1] - fit.tone0[0];
+        for (size_t k = 0; k < K; ++k) {
+            const int step = static_cast<int>(k) * fit.stride;
+            if (fit.tone0[k] != fit.tone0[0] + step || fit.tone15[k] != fit.tone15[0] + step) {
+                why = "preamble lines at N = " + std::to_string(N) + " are not evenly spaced sub-bands";
+                return false;
+            }
+        }
+    }
+
+    // 前导长度：从起点数 tone0 / tone15 交替的符号。开头几个符号从严，用来排除错误的 N
+    int sync = 0;
+    for (size_t w = start; w + N <= x.size(); w += N, ++sync) {
+        const double p0 = linesPower(x.data() + w, N, fit.tone0);
+        const double p1 = linesPower(x.data() + w, N, fit.tone15);
+        const double expected = (sync % 2 == 0) ? p0 : p1;
+        const double other = (sync % 2 == 0) ? p1 : p0;
+        const double ratio = sync < HEAD_SYMBOLS ? HEAD_RATIO : COUNT_RATIO;
+        if (expected < SYMBOL_ON_RATIO * fit.ref || expected < ratio * other) {
+            break;
+        }
+    }
+    if (sync < HEAD_SYMBOLS) {
+        why = "only " + std::to_string(sync) + " alternating symbols at N = " + std::to_string(N);
+        return false;
+    }
+    fit.sync = sync;
+    return true;
+}
+
+// 换算回 N 时不受截断影响的最短小数（makeDemodPlan 按 sampleRate * symdur 截断取 N）
+double symbolDuration(uint32_t N, uint32_t sampleRate) {
+    for (int digits = 3; digits <= 12; ++digits) {
+        const double scale = std::pow(10.0, digits);
+        const double v = std::round(static_cast<double>(N) / sampleRate * scale) / scale;
+        if (v > 0.0 && static_cast<uint32_t>(sampleRate * v) == N) {
+            return v;
+        }
+    }
+    return (N + 0.5) / sampleRate;
+}
+
+// 6. 依次尝试零尾 / 咬尾 FEC、无 / 有模式头，以及少计一个符号的前导长度（数据段第一个符号
+//    恰好延续交替图样时会多数一个；前导通常为偶数个符号，计数为奇数时先试少一个的）。
+//    噪声下定时可能差一两个样本，起点上都不通过时再在附近试几个偏移。
+//    整帧 CRC 通过的组合优先，所有偏移都试过后才退而取帧头 marker 正确的第一个组合；
+//    complete（整个文件都已读入）时帧超出录音说明组合不对，不算帧头通过
+void verifyHeader(const std::vector<float>& x, bool complete, const DecodeParams& hints, SignalAnalysis& r) {
+    DecodeWorkspace ws;
+    const SignalAnalysis base = r;
+    const int counted = r.syncSymbols;
+    const int syncs[2] = {counted % 2 == 0 ? counted : counted - 1,
+                          counted % 2 == 0 ? counted - 1 : counted};
+    SignalAnalysis headerOnly;
+    for (int offset : {0, -1, 1, -2, 2}) {
+        if (offset < 0 && base.startSample < static_cast<uint64_t>(-offset)) continue;
+        bool headerHere = false;
+        for (bool adaptive : {false, true}) {
+            // 模式头只用于单子带；同一偏移上没有模式头的组合已经解出帧头时也不再试
+            if (adaptive && (base.subbands > 1 || headerHere)) break;
+            for (bool tailBiting : {false, true}) {
+                for (int sync : syncs) {
+                    SignalAnalysis cand = base;
+                    cand.startSample = base.startSample + offset;
+                    cand.syncSymbols = sync;
+                    cand.tailBiting = tailBiting;
+                    cand.adaptive = adaptive;
+                    cand.headerFound = true;
+                    DecodeParams p = hints;
+                    applyAnalysis(cand, p);
+                    p.verbose = false;
+                    DecoderPlan plan;
+                    if (sync < 2 || !buildDecoderPlan(p, plan) ||
+                        !probeFirstFrame(x.data() + cand.startSample, x.size() - cand.startSample, plan, ws,
+                                         cand.payloadLen, cand.crcChecked)) {
+                        continue;
+                    }
+                    if (cand.crcChecked) {
+                        r = cand;
+                        return;
+                    }
+                    if (complete) continue;
+                    headerHere = true;
+                    if (!headerOnly.headerFound) {
+                        headerOnly = cand;
+                    }
+                }
+            }
+        }
+    }
+    if (headerOnly.headerFound) {
+        r = headerOnly;
+    }
+}
+
+} // namespace
+
+bool analyzeSignal(
+    const std::string& inputWavPath,
+    const DecodeParams& hints,
+    const AnalyzeParams& analyze,
+    SignalAnalysis& result
+) {
+    result = SignalAnalysis{};
+    std::vector<float> x;
+    bool complete = false;
+    if (!loadHead(inputWavPath, hints, analyze.maxSeconds, x, result.sampleRate, complete)) {
+        return false;
+    }
+
+    // 1. 起点；跳过起点所在的块，后面的窗口都落在前导内
+    size_t onset = 0;
+    if (!findOnset(x, onset)) {
+        std::cerr << "No signal found in the first " << analyze.maxSeconds << " s.\n";
+        return false;
+    }
+    const size_t s0 = onset + ONSET_BLOCK;
+
+    // 2..4. 按自相关从高到低逐个候选周期检查前导结构
+    std::vector<double> scores;
+    const std::vector<size_t> candidates =
+        findPeriodCandidates(x, s0, 2 * static_cast<size_t>(analyze.maxSymbolSamples), scores);
+    PreambleFit fit;
+    std::string why = "no periodic signal";
+    uint32_t N = 0;
+    for (size_t lag : candidates) {
+        const uint32_t n = static_cast<uint32_t>(lag / 2);
+        if (fitPreamble(x, s0, n, fit, why)) {
+            N = n;
+            result.periodScore = scores[lag];
+            break;
+        }
+    }
+    if (N == 0) {
+        std::cerr << "No tone 0 / tone 15 preamble found (" << why << ").\n";
+        return false;
+    }
+    result.symbolSamples = N;
+    result.symbolDurationSec = symbolDuration(N, result.sampleRate);
+    result.startSample = fit.start;
+    result.syncSymbols = fit.sync;
+    result.subbands = static_cast<int>(fit.tone0.size());
+    result.subbandStride = fit.stride;
+    const int K = result.subbands;
+    const int sync = fit.sync;
+    const size_t start = fit.start;
+    const double ref = fit.ref;
+
+    // 5. 数据段：子带 0 在 tone0 与 tone15 之间每符号最强的 bin
+    const int b0 = fit.tone0[0];
+    const int b15 = fit.tone15[0];
+    const int lo = std::min(b0, b15);
+    const int hi = std::max(b0, b15);
+    std::vector<uint32_t> hist(static_cast<size_t>(hi - lo + 1), 0);
+    uint32_t counted = 0;
+    const size_t dataStart = start + static_cast<size_t>(sync) * N;
+    for (size_t i = 0; i < static_cast<size_t>(analyze.dataSymbols); ++i) {
+        const size_t w = dataStart + i * N;
+        if (w + N > x.size()) break;
+        int bestBin = lo;
+        double bestPower = -1.0;
+        for (int b = lo; b <= hi; ++b) {
+            const double p = goertzelPower(x.data() + w, N, static_cast<double>(b) / N);
+            if (p > bestPower) {
+                bestPower = p;
+                bestBin = b;
+            }
+        }
+        if (bestPower < 0.1 * ref / K) continue;   // 传输结束后的静音
+        ++hist[static_cast<size_t>(bestBin - lo)];
+        ++counted;
+    }
+    const uint32_t minCount = std::max<uint32_t>(2, counted / 100);
+    std::vector<int> seen;
+    for (int b = lo; b <= hi; ++b) {
+        if (hist[static_cast<size_t>(b - lo)] >= minCount || b == lo || b == hi) {
+            seen.push_back(b);
+        }
+    }
+    result.tonesObserved = static_cast<int>(seen.size());
+
+    // 音序号按 bin 从 tone0 单调走向 tone15；没看全 16 个音时只能按连续排列推断
+    if (seen.size() != 16) {
+        if (hi - lo != 15) {
+            std::cerr << "Found " << seen.size() << " distinct tones between bin " << lo << " and " << hi
+                      << ", cannot infer the 16-tone bin set.\n";
+            return false;
+        }
+        seen.clear();
+        for (int b = lo; b <= hi; ++b) seen.push_back(b);
+    }
+    if (b0 > b15) {
+        std::reverse(seen.begin(), seen.end());
+    }
+    std::copy(seen.begin(), seen.end(), result.bins.begin());
+
+    // 6. 帧头验证
+    verifyHeader(x, complete, hints, result);
+    return true;
+}
+
+void applyAnalysis(const SignalAnalysis& result, DecodeParams& params) {
+    params.sampleRate        = result.sampleRate;
+    params.symbolDurationSec = result.symbolDurationSec;
+    params.syncSymbols       = result.syncSymbols;
+    params.bins              = result.bins;
+    params.subbands          = result.subbands;
+    params.subbandStride     = result.subbands > 1 ? result.subbandStride : 0;
+    params.startSample       = result.startSample;
+    if (result.headerFound) {
+        params.tailBiting = result.tailBiting;
+        params.adaptive   = result.adaptive;
+    }
+}
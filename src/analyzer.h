@@ -0,0 +1,56 @@
+// src/analyzer.h
+#pragma once
+#include "decoder.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// 盲参数识别：不知道 --sr / --symdur / --bin* 时，从录音开头的前导直接测出解码参数
+//
+// 前导是 tone0 / tone15 交替，且 bin 对齐的单音每符号恰好整数个周期，
+// 所以前导是周期严格为 2N 的信号：
+//   1. 块能量门限找到信号起点
+//   2. 归一化自相关在 2N 处接近 1 -> 候选符号长度 N（按从短到长逐个检查 3、4）
+//   3. 整周期（2N 点）窗口的 DFT 只在偶数下标 2b 上有谱线 -> 前导各子带 tone0 / tone15 的 bin
+//   4. 这些 bin 上的滑动 DFT 对符号边界最敏感 -> 符号定时与前导起点；按交替图样数出前导长度
+//   5. 数据段逐符号（与定时对齐的 N 点窗口）找子带 0 内的最强 bin -> 16 个音的 bin
+//   6. 用识别出的参数解出第一帧并校验 CRC（零尾 / 咬尾 FEC、是否带模式头依次尝试）作为验证
+// 采样率取自 WAV 头；前提是录音采样率与发送端一致（重采样过的录音 N 不再是整数）
+struct AnalyzeParams {
+    uint32_t maxSymbolSamples = 4096;   // 搜索的最长符号（样本数）
+    double   maxSeconds       = 30.0;   // 最多读入多少秒录音
+    int      dataSymbols      = 512;    // 统计数据段音集合用的符号数上限
+};
+
+struct SignalAnalysis {
+    uint32_t sampleRate        = 0;
+    uint32_t symbolSamples     = 0;     // N
+    double   symbolDurationSec = 0.0;   // 换算回 N 不受截断影响的最短小数（可直接作为 --symdur）
+    double   periodScore       = 0.0;   // 2N 处的归一化自相关，接近 1 表示干净的前导
+    uint64_t startSample       = 0;     // 前导起点
+    int      syncSymbols       = 0;
+    int      subbands          = 1;
+    int      subbandStride     = 0;     // 仅 subbands > 1 时有意义
+    std::array<int, 16> bins{};
+    int      tonesObserved     = 0;     // 数据段中实际出现的音数；不足 16 时其余 bin 按连续排列推断
+
+    // 帧头验证（headerFound 为 false 时下面几项无意义）
+    bool     headerFound       = false;
+    bool     tailBiting        = false;
+    bool     adaptive          = false;
+    bool     crcChecked        = false; // 第一帧整帧通过 CRC；false 时只验证了帧头（帧比读入的录音长）
+    size_t   payloadLen        = 0;     // 第一帧的 payload 长度（帧头中的值）
+};
+
+// 分析 inputWavPath 开头一段。hints 只取 rawPcm / sampleRate（裸 PCM 的采样率）和 fixedPoint；
+// 找不到前导时打印原因并返回 false。帧头验证失败不算失败（headerFound 为 false）
+bool analyzeSignal(
+    const std::string& inputWavPath,
+    const DecodeParams& hints,
+    const AnalyzeParams& analyze,
+    SignalAnalysis& result
+);
+
+// 把识别结果写入解码参数：采样率、符号时长、bins、子带、前导长度、起点、FEC 变体与自适应
+void applyAnalysis(const SignalAnalysis& result, DecodeParams& params);
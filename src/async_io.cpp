@@ -0,0 +1,918 @@
+// src/async_io.cpp
+#include "async_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// io_uring 直接走系统调用：只需要内核头文件，不引入 liburing 依赖
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define AUDIO_CODEC_IO_URING 1
+#endif
+#endif
+#endif
+
+// 两个后端的公共部分：当前块的读/写游标
+struct AsyncReader::Engine {
+    virtual ~Engine() = default;
+    virtual const char* name() const = 0;
+
+    // 交还当前块（后台可以继续往里预读），换下一个读好的块到 cur/avail；EOF 或出错时返回 false
+    virtual bool fetch() = 0;
+
+    // 丢弃预读的块，从文件偏移 offset 重新开始预读
+    virtual bool seek(uint64_t offset) = 0;
+
+    // 可由其它线程调用：唤醒阻塞在 fetch 中的读取方，之后的 fetch 都按 EOF 返回
+    virtual void cancel() {}
+
+    const uint8_t* cur    = nullptr;
+    size_t         avail  = 0;
+    uint64_t       pos    = 0;
+    bool           failed = false;
+};
+
+struct AsyncWriter::Engine {
+    virtual ~Engine() = default;
+    virtual const char* name() const = 0;
+
+    // 把当前块（前 used 字节）交给后台写出，换一个空闲块到 cur；有写出失败过时返回 false
+    virtual bool flushBlock() = 0;
+
+    // 写出剩余数据、等全部完成并关闭文件
+    virtual bool finish() = 0;
+
+    uint8_t* cur    = nullptr;
+    size_t   used   = 0;
+    bool     failed = false;
+};
+
+namespace {
+
+constexpr size_t BLOCK_BYTES = size_t(1) << 20;   // 每块 1 MiB
+constexpr size_t BLOCKS      = 4;                 // 轮转块数：1 块在用，其余在途
+
+// ---- 平台文件描述符操作 ----
+
+#ifdef _WIN32
+constexpr int STDIN_FD  = 0;
+constexpr int STDOUT_FD = 1;
+
+int openForRead(const std::string& path) {
+    return _open(path.c_str(), _O_RDONLY | _O_BINARY);
+}
+
+int openForWrite(const std::string& path) {
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+long readSome(int fd, void* buf, size_t n) {
+    return _read(fd, buf, static_cast<unsigned>(std::min<size_t>(n, INT_MAX)));
+}
+
+long writeSome(int fd, const void* buf, size_t n) {
+    return _write(fd, buf, static_cast<unsigned>(std::min<size_t>(n, INT_MAX)));
+}
+
+int closeFd(int fd) { return _close(fd); }
+
+bool seekFd(int fd, uint64_t offset) {
+    return _lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) >= 0;
+}
+#else
+constexpr int STDIN_FD  = STDIN_FILENO;
+constexpr int STDOUT_FD = STDOUT_FILENO;
+
+int openForRead(const std::string& path) {
+    return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+int openForWrite(const std::string& path) {
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+}
+
+// 管道上有多少读多少（不必等满一块），被信号打断时重试
+long readSome(int fd, void* buf, size_t n) {
+    for (;;) {
+        const ssize_t r = ::read(fd, buf, n);
+        if (r >= 0 || errno != EINTR) return static_cast<long>(r);
+    }
+}
+
+long writeSome(int fd, const void* buf, size_t n) {
+    for (;;) {
+        const ssize_t r = ::write(fd, buf, n);
+        if (r >= 0 || errno != EINTR) return static_cast<long>(r);
+    }
+}
+
+int closeFd(int fd) { return ::close(fd); }
+
+bool seekFd(int fd, uint64_t offset) {
+    return ::lseek(fd, static_cast<off_t>(offset), SEEK_SET) >= 0;
+}
+#endif
+
+// 写完 n 字节；失败时返回 errno
+int writeAll(int fd, const uint8_t* p, size_t n) {
+    while (n > 0) {
+        const long w = writeSome(fd, p, n);
+        if (w <= 0) return w < 0 ? errno : EIO;
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return 0;
+}
+
+// AUDIO_CODEC_IO=thread 时禁用 io_uring
+bool uringAllowed() {
+    static const bool allowed = [] {
+        const char* env = std::getenv("AUDIO_CODEC_IO");
+        if (!env || std::strcmp(env, "uring") == 0) return true;
+        if (std::strcmp(env, "thread") == 0) return false;
+        std::cerr << "Warning: unknown AUDIO_CODEC_IO '" << env << "', expected uring|thread\n";
+        return true;
+    }();
+    return allowed;
+}
+
+// ---- 线程后端：后台线程顺序读写，适用于任何 fd（管道、终端、普通文件） ----
+
+// stdin 上的读可能一直阻塞（上游还没写、也没关），析构时不能等它：
+// 状态放在与后台线程共享的对象里，stdin 的读线程直接 detach
+class ThreadReadEngine final : public AsyncReader::Engine {
+public:
+    ThreadReadEngine(int fd, bool ownsFd) : s_(std::make_shared<Shared>()), ownsFd_(ownsFd) {
+        s_->fd = fd;
+        for (auto& b : s_->blocks) b.data.resize(BLOCK_BYTES);
+        worker_ = std::thread(&ThreadReadEngine::run, s_);
+    }
+
+    ~ThreadReadEngine() override {
+        stop();
+        if (ownsFd_) closeFd(s_->fd);
+    }
+
+    const char* name() const override { return "thread"; }
+
+    bool seek(uint64_t offset) override {
+        if (!ownsFd_) {
+            std::cerr << "Read error: standard input is not seekable\n";
+            failed = true;
+            return false;
+        }
+        stop();
+        if (!seekFd(s_->fd, offset)) {
+            std::cerr << "Read error: " << std::strerror(errno) << "\n";
+            failed = true;
+            return false;
+        }
+        Shared& s = *s_;
+        s.filled   = 0;
+        s.released = 0;
+        s.done     = false;
+        s.stopping = false;
+        s.error    = 0;
+        taken_   = 0;
+        holding_ = false;
+        cur   = nullptr;
+        avail = 0;
+        pos   = offset;
+        worker_ = std::thread(&ThreadReadEngine::run, s_);
+        return true;
+    }
+
+    bool fetch() override {
+        Shared& s = *s_;
+        std::unique_lock<std::mutex> lock(s.mutex);
+        if (holding_) {
+            ++s.released;
+            holding_ = false;
+            s.cv.notify_all();
+        }
+        s.cv.wait(lock, [&] { return s.filled > taken_ || s.done || s.cancelled; });
+        if (s.cancelled) return false;
+        if (s.filled == taken_) {
+            if (s.error && !failed) {
+                std::cerr << "Read error: " << std::strerror(s.error) << "\n";
+                failed = true;
+            }
+            return false;
+        }
+        const Block& b = s.blocks[taken_ % BLOCKS];
+        ++taken_;
+        holding_ = true;
+        cur   = b.data.data();
+        avail = b.len;
+        return true;
+    }
+
+    void cancel() override {
+        {
+            std::lock_guard<std::mutex> lock(s_->mutex);
+            s_->cancelled = true;
+        }
+        s_->cv.notify_all();
+    }
+
+private:
+    struct Block {
+        std::vector<uint8_t> data;
+        size_t               len = 0;
+    };
+
+    struct Shared {
+        int                     fd = -1;
+        std::vector<Block>      blocks = std::vector<Block>(BLOCKS);   // 第 s 个块放在 blocks[s % BLOCKS]
+        std::mutex              mutex;
+        std::condition_variable cv;
+        size_t                  filled   = 0;   // 后台已读好的块数
+        size_t                  released = 0;   // 读取方已用完、可以覆盖的块数
+        bool                    done     = false;
+        bool                    stopping = false;
+        bool                    cancelled = false;
+        int                     error    = 0;
+    };
+
+    // 自己打开的文件等后台线程退出；stdin 的读线程 detach
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(s_->mutex);
+            s_->stopping = true;
+        }
+        s_->cv.notify_all();
+        if (!worker_.joinable()) return;
+        if (ownsFd_) {
+            worker_.join();
+        } else {
+            worker_.detach();
+        }
+    }
+
+    static void run(std::shared_ptr<Shared> sp) {
+        Shared& s = *sp;
+        for (;;) {
+            size_t idx;
+            {
+                std::unique_lock<std::mutex> lock(s.mutex);
+                s.cv.wait(lock, [&] { return s.stopping || s.filled - s.released < BLOCKS; });
+                if (s.stopping) return;
+                idx = s.filled % BLOCKS;
+            }
+            const long n = readSome(s.fd, s.blocks[idx].data.data(), BLOCK_BYTES);
+            const int err = n < 0 ? errno : 0;
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (n > 0) {
+                    s.blocks[idx].len = static_cast<size_t>(n);
+                    ++s.filled;
+                } else {
+                    s.done  = true;
+                    s.error = err;
+                }
+            }
+            s.cv.notify_all();
+            if (n <= 0) return;
+        }
+    }
+
+    std::shared_ptr<Shared> s_;
+    bool                    ownsFd_;
+    size_t                  taken_   = 0;   // 读取方已取走的块数
+    bool                    holding_ = false;
+    std::thread             worker_;
+};
+
+class ThreadWriteEngine final : public AsyncWriter::Engine {
+public:
+    ThreadWriteEngine(int fd, bool ownsFd) : fd_(fd), ownsFd_(ownsFd), blocks_(BLOCKS) {
+        for (auto& b : blocks_) b.data.resize(BLOCK_BYTES);
+        cur = blocks_[0].data.data();
+        worker_ = std::thread(&ThreadWriteEngine::run, this);
+    }
+
+    ~ThreadWriteEngine() override {
+        stop();
+        if (ownsFd_) closeFd(fd_);
+    }
+
+    const char* name() const override { return "thread"; }
+
+    bool flushBlock() override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        blocks_[submitted_ % BLOCKS].len = used;
+        ++submitted_;
+        cv_.notify_all();
+        cv_.wait(lock, [&] { return submitted_ - written_ < BLOCKS; });
+        cur  = blocks_[submitted_ % BLOCKS].data.data();
+        used = 0;
+        return !reportError();
+    }
+
+    bool finish() override {
+        if (used > 0) flushBlock();
+        stop();
+        bool ok = !reportError();
+        if (ownsFd_) {
+            ownsFd_ = false;
+            if (closeFd(fd_) != 0 && ok) {
+                std::cerr << "Write error: " << std::strerror(errno) << "\n";
+                failed = true;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+private:
+    struct Block {
+        std::vector<uint8_t> data;
+        size_t               len = 0;
+    };
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        if (worker_.joinable()) worker_.join();
+    }
+
+    // 调用方持有锁或写线程已退出
+    bool reportError() {
+        if (error_ && !failed) {
+            std::cerr << "Write error: " << std::strerror(error_) << "\n";
+            failed = true;
+        }
+        return failed;
+    }
+
+    void run() {
+        for (;;) {
+            size_t idx;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return stopping_ || written_ < submitted_; });
+                if (written_ == submitted_) return;   // stopping_ 且已写完
+                idx = written_ % BLOCKS;
+            }
+            // 出错后不再写，但继续推进计数，写入方不会卡住
+            const int err = error_ ? 0 : writeAll(fd_, blocks_[idx].data.data(), blocks_[idx].len);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (err) error_ = err;
+                ++written_;
+            }
+            cv_.notify_all();
+        }
+    }
+
+    int                fd_;
+    bool               ownsFd_;
+    std::vector<Block> blocks_;
+
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    size_t                  submitted_ = 0;   // 写入方交出的块数
+    size_t                  written_   = 0;   // 写线程写完的块数
+    bool                    stopping_  = false;
+    int                     error_     = 0;
+    std::thread             worker_;
+};
+
+#ifdef AUDIO_CODEC_IO_URING
+
+// ---- io_uring 后端：普通文件的各块读/写同时提交给内核，按偏移 pread/pwrite 语义 ----
+
+class Ring {
+public:
+    Ring() = default;
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    ~Ring() {
+        if (sqes_) munmap(sqes_, sqesLen_);
+        if (cqMap_ && cqMap_ != sqMap_) munmap(cqMap_, cqLen_);
+        if (sqMap_) munmap(sqMap_, sqLen_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    // 内核不支持或被禁用（seccomp、io_uring_disabled）时返回 false
+    bool init(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        const long fd = syscall(__NR_io_uring_setup, entries, &p);
+        if (fd < 0) return false;
+        fd_ = static_cast<int>(fd);
+
+        sqLen_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqLen_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqLen_ = cqLen_ = std::max(sqLen_, cqLen_);
+
+        void* sq = mmap(nullptr, sqLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd_, IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) return false;
+        sqMap_ = sq;
+        if (single) {
+            cqMap_ = sqMap_;
+        } else {
+            void* cq = mmap(nullptr, cqLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            fd_, IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED) return false;
+            cqMap_ = cq;
+        }
+        sqesLen_ = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, sqesLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        char* sqBase = static_cast<char*>(sqMap_);
+        char* cqBase = static_cast<char*>(cqMap_);
+        sqTail_  = reinterpret_cast<unsigned*>(sqBase + p.sq_off.tail);
+        sqMask_  = *reinterpret_cast<unsigned*>(sqBase + p.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sqBase + p.sq_off.array);
+        cqHead_  = reinterpret_cast<unsigned*>(cqBase + p.cq_off.head);
+        cqTail_  = reinterpret_cast<unsigned*>(cqBase + p.cq_off.tail);
+        cqMask_  = *reinterpret_cast<unsigned*>(cqBase + p.cq_off.ring_mask);
+        cqes_    = reinterpret_cast<io_uring_cqe*>(cqBase + p.cq_off.cqes);
+        return true;
+    }
+
+    // 提交一个读/写请求；tag 原样出现在完成事件里
+    bool submit(uint8_t op, int fd, void* buf, size_t len, uint64_t offset, uint64_t tag) {
+        const unsigned tail = *sqTail_;
+        const unsigned idx  = tail & sqMask_;
+        io_uring_sqe& sqe = sqes_[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode    = op;
+        sqe.fd        = fd;
+        sqe.addr      = reinterpret_cast<uint64_t>(buf);
+        sqe.len       = static_cast<uint32_t>(len);
+        sqe.off       = offset;
+        sqe.user_data = tag;
+        sqArray_[idx] = idx;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+        for (;;) {
+            const long r = syscall(__NR_io_uring_enter, fd_, 1u, 0u, 0u, nullptr, 0);
+            if (r >= 0) return r == 1;
+            if (errno != EINTR) return false;
+        }
+    }
+
+    // 等一个完成事件；res 为读/写字节数或 -errno
+    bool wait(uint64_t& tag, int32_t& res) {
+        for (;;) {
+            const unsigned head = *cqHead_;
+            if (head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                tag = cqe.user_data;
+                res = cqe.res;
+                __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            const long r = syscall(__NR_io_uring_enter, fd_, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (r < 0 && errno != EINTR) return false;
+        }
+    }
+
+private:
+    int           fd_      = -1;
+    void*         sqMap_   = nullptr;
+    void*         cqMap_   = nullptr;
+    size_t        sqLen_   = 0;
+    size_t        cqLen_   = 0;
+    size_t        sqesLen_ = 0;
+    io_uring_sqe* sqes_    = nullptr;
+    unsigned*     sqTail_  = nullptr;
+    unsigned*     sqArray_ = nullptr;
+    unsigned      sqMask_  = 0;
+    unsigned*     cqHead_  = nullptr;
+    unsigned*     cqTail_  = nullptr;
+    unsigned      cqMask_  = 0;
+    io_uring_cqe* cqes_    = nullptr;
+};
+
+constexpr unsigned RING_ENTRIES = 8;
+
+// 在途块的状态
+struct UringBlock {
+    std::vector<uint8_t> data;
+    size_t               len      = 0;   // 请求的字节数
+    uint64_t             offset   = 0;
+    bool                 inFlight = false;
+};
+
+// 内核返回的读/写不足 len 时（信号、文件尾附近、内核不支持该操作码）同步补完；
+// 返回补完后的字节数，出错时为 -errno
+long finishRead(int fd, UringBlock& b, int32_t res) {
+    size_t done = res > 0 ? static_cast<size_t>(res) : 0;
+    while (done < b.len) {
+        const ssize_t r = pread(fd, b.data.data() + done, b.len - done,
+                                static_cast<off_t>(b.offset + done));
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) return -errno;
+        if (r == 0) break;   // 文件在打开后被截短
+        done += static_cast<size_t>(r);
+    }
+    return static_cast<long>(done);
+}
+
+int finishWrite(int fd, const UringBlock& b, int32_t res) {
+    size_t done = res > 0 ? static_cast<size_t>(res) : 0;
+    while (done < b.len) {
+        const ssize_t w = pwrite(fd, b.data.data() + done, b.len - done,
+                                 static_cast<off_t>(b.offset + done));
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return w < 0 ? errno : EIO;
+        done += static_cast<size_t>(w);
+    }
+    return 0;
+}
+
+class UringReadEngine final : public AsyncReader::Engine {
+public:
+    UringReadEngine(std::unique_ptr<Ring> ring, int fd, uint64_t size)
+        : ring_(std::move(ring)), fd_(fd), size_(size), blocks_(BLOCKS) {
+        for (size_t i = 0; i < BLOCKS; ++i) {
+            blocks_[i].data.resize(BLOCK_BYTES);
+            submitBlock(i);
+        }
+    }
+
+    ~UringReadEngine() override {
+        drain();
+        closeFd(fd_);
+    }
+
+    const char* name() const override { return "io_uring"; }
+
+    bool seek(uint64_t offset) override {
+        drain();
+        next_    = std::min(offset, size_);
+        taken_   = 0;
+        holding_ = false;
+        cur   = nullptr;
+        avail = 0;
+        pos   = offset;
+        for (size_t i = 0; i < BLOCKS; ++i) {
+            submitBlock(i);
+        }
+        return !failed;
+    }
+
+    bool fetch() override {
+        if (holding_) {
+            holding_ = false;
+            submitBlock((taken_ - 1) % BLOCKS);
+        }
+        UringBlock& b = blocks_[taken_ % BLOCKS];
+        while (b.inFlight) {
+            if (!reap()) {
+                fail("io_uring wait failed");
+                return false;
+            }
+        }
+        if (b.len == 0 || failed) return false;
+        ++taken_;
+        holding_ = true;
+        cur   = b.data.data();
+        avail = b.len;
+        return true;
+    }
+
+private:
+    // 缓冲复用或释放前等内核完成在途的读
+    void drain() {
+        for (auto& b : blocks_) {
+            while (b.inFlight && reap()) {}
+        }
+    }
+
+    void submitBlock(size_t idx) {
+        UringBlock& b = blocks_[idx];
+        b.offset = next_;
+        b.len    = static_cast<size_t>(std::min<uint64_t>(BLOCK_BYTES, size_ - next_));
+        if (b.len == 0 || failed) {
+            b.len = 0;
+            return;
+        }
+        next_ += b.len;
+        b.inFlight = true;
+        if (!ring_->submit(IORING_OP_READ, fd_, b.data.data(), b.len, b.offset, idx)) {
+            b.inFlight = false;
+            fail("io_uring submit failed");
+        }
+    }
+
+    bool reap() {
+        uint64_t tag;
+        int32_t  res;
+        if (!ring_->wait(tag, res)) return false;
+        UringBlock& b = blocks_[tag];
+        b.inFlight = false;
+        const long got = (res >= 0 && static_cast<size_t>(res) == b.len) ? res : finishRead(fd_, b, res);
+        if (got < 0) {
+            fail(std::strerror(static_cast<int>(-got)));
+            b.len = 0;
+        } else {
+            b.len = static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    void fail(const char* why) {
+        if (!failed) {
+            std::cerr << "Read error: " << why << "\n";
+            failed = true;
+        }
+    }
+
+    std::unique_ptr<Ring>   ring_;
+    int                     fd_;
+    uint64_t                size_;
+    uint64_t                next_    = 0;   // 下一个要提交的文件偏移
+    std::vector<UringBlock> blocks_;        // 第 s 个块放在 blocks_[s % BLOCKS]
+    size_t                  taken_   = 0;
+    bool                    holding_ = false;
+};
+
+class UringWriteEngine final : public AsyncWriter::Engine {
+public:
+    UringWriteEngine(std::unique_ptr<Ring> ring, int fd)
+        : ring_(std::move(ring)), fd_(fd), blocks_(BLOCKS) {
+        for (auto& b : blocks_) b.data.resize(BLOCK_BYTES);
+        cur = blocks_[0].data.data();
+    }
+
+    ~UringWriteEngine() override {
+        drain();
+        if (fd_ >= 0) closeFd(fd_);
+    }
+
+    const char* name() const override { return "io_uring"; }
+
+    bool flushBlock() override {
+        UringBlock& b = blocks_[slot_];
+        b.offset = next_;
+        b.len    = used;
+        next_ += used;
+        if (!failed) {
+            b.inFlight = true;
+            if (!ring_->submit(IORING_OP_WRITE, fd_, b.data.data(), b.len, b.offset, slot_)) {
+                // 提交失败时同步写出，不丢数据
+                b.inFlight = false;
+                const int err = finishWrite(fd_, b, 0);
+                if (err) fail(std::strerror(err));
+            }
+        }
+
+        slot_ = (slot_ + 1) % BLOCKS;
+        while (blocks_[slot_].inFlight) {
+            if (!reap()) {
+                fail("io_uring wait failed");
+                break;
+            }
+        }
+        cur  = blocks_[slot_].data.data();
+        used = 0;
+        return !failed;
+    }
+
+    bool finish() override {
+        if (used > 0) flushBlock();
+        drain();
+        if (closeFd(fd_) != 0) fail(std::strerror(errno));
+        fd_ = -1;
+        return !failed;
+    }
+
+private:
+    void drain() {
+        for (auto& b : blocks_) {
+            while (b.inFlight) {
+                if (!reap()) {
+                    fail("io_uring wait failed");
+                    return;
+                }
+            }
+        }
+    }
+
+    bool reap() {
+        uint64_t tag;
+        int32_t  res;
+        if (!ring_->wait(tag, res)) return false;
+        UringBlock& b = blocks_[tag];
+        b.inFlight = false;
+        if (res < 0 || static_cast<size_t>(res) != b.len) {
+            const int err = finishWrite(fd_, b, res);
+            if (err) fail(std::strerror(err));
+        }
+        return true;
+    }
+
+    void fail(const char* why) {
+        if (!failed) {
+            std::cerr << "Write error: " << why << "\n";
+            failed = true;
+        }
+    }
+
+    std::unique_ptr<Ring>   ring_;
+    int                     fd_;
+    std::vector<UringBlock> blocks_;
+    size_t                  slot_ = 0;   // 当前填充的块
+    uint64_t                next_ = 0;   // 下一个块的文件偏移
+};
+
+// 只对自己打开的普通文件使用 io_uring：管道 / 设备不支持按偏移读写，
+// stdin/stdout 即使重定向到文件也可能与其它进程共享文件偏移
+std::unique_ptr<Ring> ringForFile(int fd, uint64_t* size) {
+    struct stat st;
+    if (!uringAllowed() || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return nullptr;
+    std::unique_ptr<Ring> ring(new Ring);
+    if (!ring->init(RING_ENTRIES)) return nullptr;
+    if (size) *size = static_cast<uint64_t>(st.st_size);
+    return ring;
+}
+
+#endif // AUDIO_CODEC_IO_URING
+
+} // namespace
+
+const char* asyncIoBackendName() {
+#ifdef AUDIO_CODEC_IO_URING
+    static const bool uring = [] {
+        Ring ring;
+        return uringAllowed() && ring.init(1);
+    }();
+    if (uring) return "io_uring";
+#endif
+    return "thread";
+}
+
+// ---- AsyncReader ----
+
+AsyncReader::AsyncReader() = default;
+AsyncReader::~AsyncReader() = default;
+
+bool AsyncReader::open(const std::string& path) {
+    close();
+    if (path == "-") {
+        engine_.reset(new ThreadReadEngine(STDIN_FD, false));
+        return true;
+    }
+    const int fd = openForRead(path);
+    if (fd < 0) return false;
+#ifdef AUDIO_CODEC_IO_URING
+    uint64_t size = 0;
+    if (std::unique_ptr<Ring> ring = ringForFile(fd, &size)) {
+        engine_.reset(new UringReadEngine(std::move(ring), fd, size));
+        return true;
+    }
+#endif
+    engine_.reset(new ThreadReadEngine(fd, true));
+    return true;
+}
+
+void AsyncReader::close() {
+    engine_.reset();
+}
+
+size_t AsyncReader::read(void* dst, size_t n) {
+    if (!engine_) return 0;
+    Engine& e = *engine_;
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    size_t done = 0;
+    while (done < n) {
+        if (e.avail == 0 && !e.fetch()) break;
+        const size_t take = std::min(e.avail, n - done);
+        std::memcpy(out + done, e.cur, take);
+        e.cur   += take;
+        e.avail -= take;
+        done    += take;
+    }
+    e.pos += done;
+    return done;
+}
+
+size_t AsyncReader::readSome(void* dst, size_t n) {
+    if (!engine_ || n == 0) return 0;
+    Engine& e = *engine_;
+    if (e.avail == 0 && !e.fetch()) return 0;
+    const size_t take = std::min(e.avail, n);
+    std::memcpy(dst, e.cur, take);
+    e.cur   += take;
+    e.avail -= take;
+    e.pos   += take;
+    return take;
+}
+
+void AsyncReader::cancel() {
+    if (engine_) engine_->cancel();
+}
+
+uint64_t AsyncReader::skip(uint64_t n) {
+    if (!engine_) return 0;
+    Engine& e = *engine_;
+    uint64_t done = 0;
+    while (done < n) {
+        if (e.avail == 0 && !e.fetch()) break;
+        const size_t take = static_cast<size_t>(std::min<uint64_t>(e.avail, n - done));
+        e.cur   += take;
+        e.avail -= take;
+        done    += take;
+    }
+    e.pos += done;
+    return done;
+}
+
+bool AsyncReader::seek(uint64_t offset) {
+    return engine_ && engine_->seek(offset);
+}
+
+uint64_t AsyncReader::tell() const {
+    return engine_ ? engine_->pos : 0;
+}
+
+bool AsyncReader::failed() const {
+    return engine_ && engine_->failed;
+}
+
+const char* AsyncReader::backend() const {
+    return engine_ ? engine_->name() : "none";
+}
+
+// ---- AsyncWriter ----
+
+AsyncWriter::AsyncWriter() = default;
+AsyncWriter::~AsyncWriter() = default;
+
+bool AsyncWriter::open(const std::string& path) {
+    close();
+    if (path == "-") {
+        engine_.reset(new ThreadWriteEngine(STDOUT_FD, false));
+        return true;
+    }
+    const int fd = openForWrite(path);
+    if (fd < 0) return false;
+#ifdef AUDIO_CODEC_IO_URING
+    if (std::unique_ptr<Ring> ring = ringForFile(fd, nullptr)) {
+        engine_.reset(new UringWriteEngine(std::move(ring), fd));
+        return true;
+    }
+#endif
+    engine_.reset(new ThreadWriteEngine(fd, true));
+    return true;
+}
+
+bool AsyncWriter::write(const void* src, size_t n) {
+    if (!engine_) return false;
+    Engine& e = *engine_;
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    while (n > 0) {
+        if (e.used == BLOCK_BYTES && !e.flushBlock()) return false;
+        const size_t take = std::min(BLOCK_BYTES - e.used, n);
+        std::memcpy(e.cur + e.used, in, take);
+        e.used += take;
+        in     += take;
+        n      -= take;
+    }
+    return !e.failed;
+}
+
+bool AsyncWriter::close() {
+    if (!engine_) return true;
+    const bool ok = engine_->finish();
+    engine_.reset();
+    return ok;
+}
+
+const char* AsyncWriter::backend() const {
+    return engine_ ? engine_->name() : "none";
+}
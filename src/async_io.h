@@ -0,0 +1,83 @@
+// src/async_io.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 顺序读写的异步文件 I/O：若干块缓冲轮转，后台预读后面的块 / 写出前面的块，
+// 解调、调制等计算与磁盘访问重叠进行。
+//
+// 两种后端：
+//   io_uring  Linux 上的普通文件，直接用系统调用（不依赖 liburing），所有块的读/写同时在途
+//   thread    其它情况（管道、stdin/stdout、非 Linux、io_uring 不可用）：一个后台线程 fread/fwrite
+// 环境变量 AUDIO_CODEC_IO=thread 可强制使用线程后端（对比 / 排查用）
+
+// 本机普通文件会用到的后端："io_uring" 或 "thread"
+const char* asyncIoBackendName();
+
+class AsyncReader {
+public:
+    AsyncReader();
+    ~AsyncReader();
+
+    AsyncReader(const AsyncReader&) = delete;
+    AsyncReader& operator=(const AsyncReader&) = delete;
+
+    // path 为 "-" 时读 stdin；打开失败返回 false（不打印，由调用方按场景报错）
+    bool open(const std::string& path);
+    void close();
+
+    // 顺序读取最多 n 字节，返回实际字节数；少于 n 表示到达 EOF 或出错（见 failed，原因已打印）
+    size_t read(void* dst, size_t n);
+
+    // 同 read，但只在一个字节都没有时才等待：返回已到达的部分（管道上不等凑满 n 字节），0 表示 EOF
+    size_t readSome(void* dst, size_t n);
+
+    // 可由其它线程调用：阻塞在 read / readSome 中等数据的读取方立即返回，之后的读取都按 EOF 处理
+    // （线程后端；io_uring 只读普通文件，不会无限期阻塞，为空操作）
+    void cancel();
+
+    // 顺序丢弃 n 字节（不 seek），返回实际丢弃的字节数
+    uint64_t skip(uint64_t n);
+
+    // 定位到文件偏移 offset，丢弃已预读的块并从新位置重新预读；
+    // stdin、管道等不可 seek 的输入返回 false（原因已打印）
+    bool seek(uint64_t offset);
+
+    // 当前读取位置（已读取 / 跳过的字节数，seek 后为新的偏移）
+    uint64_t tell() const;
+
+    bool failed() const;
+    const char* backend() const;
+
+    struct Engine;
+
+private:
+    std::unique_ptr<Engine> engine_;
+};
+
+class AsyncWriter {
+public:
+    AsyncWriter();
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    // path 为 "-" 时写 stdout；打开失败返回 false（不打印，由调用方按场景报错）
+    bool open(const std::string& path);
+
+    // 追加 n 字节（拷贝进当前块，块满后交给后台写出）；之前的写出已失败时返回 false
+    bool write(const void* src, size_t n);
+
+    // 写出剩余数据并关闭；任何一次写出失败都返回 false（原因已打印）
+    bool close();
+
+    const char* backend() const;
+
+    struct Engine;
+
+private:
+    std::unique_ptr<Engine> engine_;
+};
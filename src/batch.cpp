@@ -0,0 +1,169 @@
+// src/batch.cpp
+#include "batch.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BatchResult {
+    bool   ok = false;
+    double ms = 0.0;
+};
+
+std::string defaultOutput(const std::string& input,
+                          const std::string& outputDir,
+                          const std::string& outputExt) {
+    fs::path out = fs::path(outputDir) / fs::path(input).stem();
+    out += outputExt;
+    return out.string();
+}
+
+// 在线程池中对每个任务执行 fn，收集结果并打印汇总
+size_t runBatch(
+    const char* what,
+    const std::vector<BatchJob>& jobs,
+    unsigned threads,
+    const std::function<bool(const BatchJob&)>& fn
+) {
+    std::vector<BatchResult> results(jobs.size());
+    auto t0 = std::chrono::steady_clock::now();
+
+    unsigned usedThreads;
+    {
+        WorkStealingPool pool(threads);
+        usedThreads = pool.size();
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            pool.submit([&, i] {
+                auto start = std::chrono::steady_clock::now();
+                bool ok = false;
+                try {
+                    ok = fn(jobs[i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error (" << jobs[i].input << "): " << e.what() << "\n";
+                }
+                results[i].ok = ok;
+                results[i].ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+            });
+        }
+        pool.wait();
+    }
+
+    double totalMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+
+    // 汇总：逐文件结果 + 统计，一次性输出，避免与各线程的日志交错
+    std::ostringstream oss;
+    size_t failed = 0;
+    oss << "\n" << what << " batch summary:\n";
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (!results[i].ok) ++failed;
+        oss << (results[i].ok ? "  OK    " : "  FAIL  ")
+            << jobs[i].input << " -> " << jobs[i].output
+            << "  (" << results[i].ms << " ms)\n";
+    }
+    oss << jobs.size() << " files, " << (jobs.size() - failed) << " ok, "
+        << failed << " failed, " << totalMs << " ms total on "
+        << usedThreads << " threads\n";
+    std::cout << oss.str();
+    return failed;
+}
+
+} // namespace
+
+bool collectBatchJobs(
+    const std::string& manifestOrDir,
+    const std::string& outputDir,
+    const std::string& filterExt,
+    const std::string& outputExt,
+    std::vector<BatchJob>& jobs
+) {
+    jobs.clear();
+    std::error_code ec;
+
+    if (fs::is_directory(manifestOrDir, ec)) {
+        for (const auto& entry : fs::directory_iterator(manifestOrDir, ec)) {
+            if (!entry.is_regular_file()) continue;
+            if (!filterExt.empty() && entry.path().extension() != filterExt) continue;
+            std::string in = entry.path().string();
+            jobs.push_back({ in, defaultOutput(in, outputDir, outputExt) });
+        }
+        if (ec) {
+            std::cerr << "Failed to list directory: " << manifestOrDir << "\n";
+            return false;
+        }
+    } else {
+        std::ifstream ifs(manifestOrDir);
+        if (!ifs) {
+            std::cerr << "Failed to open manifest: " << manifestOrDir << "\n";
+            return false;
+        }
+        std::string line;
+        while (std::getline(ifs, line)) {
+            std::istringstream iss(line);
+            BatchJob job;
+            if (!(iss >> job.input) || job.input[0] == '#') continue;
+            if (!(iss >> job.output)) {
+                job.output = defaultOutput(job.input, outputDir, outputExt);
+            }
+            jobs.push_back(job);
+        }
+    }
+
+    // 目录遍历顺序不确定，排序后汇总输出稳定
+    std::sort(jobs.begin(), jobs.end(),
+              [](const BatchJob& a, const BatchJob& b) { return a.input < b.input; });
+
+    if (jobs.empty()) {
+        std::cerr << "No input files found in: " << manifestOrDir << "\n";
+        return false;
+    }
+
+    if (!outputDir.empty()) {
+        fs::create_directories(outputDir, ec);
+        if (ec) {
+            std::cerr << "Failed to create output directory: " << outputDir << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t runEncodeBatch(const std::vector<BatchJob>& jobs, const EncodeParams& params, unsigned threads) {
+    // 所有文件共用一份 LUT
+    EncodeParams quiet = params;
+    quiet.verbose = false;
+    EncoderPlan plan;
+    if (!buildEncoderPlan(quiet, plan)) {
+        return jobs.size();
+    }
+
+    return runBatch("Encode", jobs, threads, [&plan](const BatchJob& job) {
+        return encodeFileToWav(job.input, job.output, plan);
+    });
+}
+
+size_t runDecodeBatch(const std::vector<BatchJob>& jobs, const DecodeParams& params, unsigned threads) {
+    // 所有文件共用一份 Goertzel 系数 / Hann 窗
+    DecodeParams quiet = params;
+    quiet.verbose = false;
+    DecoderPlan plan;
+    if (!buildDecoderPlan(quiet, plan)) {
+        return jobs.size();
+    }
+
+    return runBatch("Decode", jobs, threads, [&plan](const BatchJob& job) {
+        // 每个工作线程复用一份解码工作区，文件之间不再重复分配缓冲
+        thread_local DecodeWorkspace ws;
+        return decodeWavToFile(job.input, job.output, plan, ws);
+    });
+}
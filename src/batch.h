@@ -0,0 +1,29 @@
+// src/batch.h
+#pragma once
+#include "encoder.h"
+#include "decoder.h"
+
+#include <string>
+#include <vector>
+
+struct BatchJob {
+    std::string input;
+    std::string output;
+};
+
+// 从清单文件或目录收集批处理任务
+// 清单：每行 "<input> [output]"，空行和 # 开头的行忽略；未给出 output 时输出到 outputDir
+// 目录：取其中的普通文件（filterExt 非空时只取该扩展名，如 ".wav"）
+// 自动生成的输出路径为 outputDir/<文件名去扩展名><outputExt>
+bool collectBatchJobs(
+    const std::string& manifestOrDir,
+    const std::string& outputDir,
+    const std::string& filterExt,
+    const std::string& outputExt,
+    std::vector<BatchJob>& jobs
+);
+
+// 用共享的编码/解码计划和 work-stealing 线程池处理所有任务，结束时打印汇总
+// threads = 0 表示使用硬件线程数；返回失败的文件数
+size_t runEncodeBatch(const std::vector<BatchJob>& jobs, const EncodeParams& params, unsigned threads);
+size_t runDecodeBatch(const std::vector<BatchJob>& jobs, const DecodeParams& params, unsigned threads);
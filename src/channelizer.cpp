@@ -0,0 +1,253 @@
+// src/channelizer.cpp
+#include "channelizer.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// FFT 每个输出样本每级的运算量（flop），radix-4 一级相当于两级 radix-2
+constexpr double RADIX2_FLOPS = 5.0;
+constexpr double RADIX4_FLOPS = 9.0;
+
+// 通用奇数基数 p：每组 p 个输出做 p*p 次复数乘加，再各乘一次旋转因子
+double radixFlops(int p) {
+    if (p == 2) return RADIX2_FLOPS;
+    if (p == 4) return RADIX4_FLOPS;
+    return 8.0 * p + 6.0;
+}
+
+// 一级 Stockham DIF：长度 n = p * m 的子序列共 s 个（交错存放），
+// y[k + s*(p*q + j)] = W_n^{jq} * Σ_r x[k + s*(q + m*r)] * W_p^{jr}
+void radix2Stage(const float* xr, const float* xi, float* yr, float* yi,
+                 uint32_t m, uint32_t s, uint32_t step, const FftPlan& plan) {
+    for (uint32_t q = 0; q < m; ++q) {
+        const float wr = plan.twRe[q * step];
+        const float wi = plan.twIm[q * step];
+        for (uint32_t k = 0; k < s; ++k) {
+            const size_t a = k + static_cast<size_t>(s) * q;
+            const size_t b = a + static_cast<size_t>(s) * m;
+            const size_t o = k + static_cast<size_t>(s) * 2 * q;
+            const float dr = xr[a] - xr[b];
+            const float di = xi[a] - xi[b];
+            yr[o] = xr[a] + xr[b];
+            yi[o] = xi[a] + xi[b];
+            yr[o + s] = dr * wr - di * wi;
+            yi[o + s] = dr * wi + di * wr;
+        }
+    }
+}
+
+void radix4Stage(const float* xr, const float* xi, float* yr, float* yi,
+                 uint32_t m, uint32_t s, uint32_t step, const FftPlan& plan) {
+    const size_t sm = static_cast<size_t>(s) * m;
+    for (uint32_t q = 0; q < m; ++q) {
+        const float w1r = plan.twRe[q * step],     w1i = plan.twIm[q * step];
+        const float w2r = plan.twRe[2 * q * step], w2i = plan.twIm[2 * q * step];
+        const float w3r = plan.twRe[3 * q * step], w3i = plan.twIm[3 * q * step];
+        for (uint32_t k = 0; k < s; ++k) {
+            const size_t a = k + static_cast<size_t>(s) * q;
+            const size_t o = k + static_cast<size_t>(s) * 4 * q;
+            const float t0r = xr[a] + xr[a + 2 * sm], t0i = xi[a] + xi[a + 2 * sm];
+            const float t1r = xr[a] - xr[a + 2 * sm], t1i = xi[a] - xi[a + 2 * sm];
+            const float t2r = xr[a + sm] + xr[a + 3 * sm], t2i = xi[a + sm] + xi[a + 3 * sm];
+            // (a1 - a3) * (-i)
+            const float t3r = xi[a + sm] - xi[a + 3 * sm], t3i = xr[a + 3 * sm] - xr[a + sm];
+
+            const float b1r = t1r + t3r, b1i = t1i + t3i;
+            const float b2r = t0r - t2r, b2i = t0i - t2i;
+            const float b3r = t1r - t3r, b3i = t1i - t3i;
+            yr[o] = t0r + t2r;
+            yi[o] = t0i + t2i;
+            yr[o + s] = b1r * w1r - b1i * w1i;
+            yi[o + s] = b1r * w1i + b1i * w1r;
+            yr[o + 2 * s] = b2r * w2r - b2i * w2i;
+            yi[o + 2 * s] = b2r * w2i + b2i * w2r;
+            yr[o + 3 * s] = b3r * w3r - b3i * w3i;
+            yi[o + 3 * s] = b3r * w3i + b3i * w3r;
+        }
+    }
+}
+
+void genericStage(const float* xr, const float* xi, float* yr, float* yi,
+                  int p, uint32_t m, uint32_t s, uint32_t step, const FftPlan& plan,
+                  FftScratch& scratch) {
+    const uint32_t rootStep = plan.N / static_cast<uint32_t>(p);
+    scratch.tmpRe.resize(static_cast<size_t>(p));
+    scratch.tmpIm.resize(static_cast<size_t>(p));
+    float* tr = scratch.tmpRe.data();
+    float* ti = scratch.tmpIm.data();
+    for (uint32_t q = 0; q < m; ++q) {
+        for (uint32_t k = 0; k < s; ++k) {
+            for (int r = 0; r < p; ++r) {
+                const size_t a = k + static_cast<size_t>(s) * (q + static_cast<size_t>(m) * r);
+                tr[r] = xr[a];
+                ti[r] = xi[a];
+            }
+            for (int j = 0; j < p; ++j) {
+                float sr = 0.0f;
+                float si = 0.0f;
+                for (int r = 0; r < p; ++r) {
+                    const uint32_t e = static_cast<uint32_t>((j * r) % p) * rootStep;
+                    sr += tr[r] * plan.twRe[e] - ti[r] * plan.twIm[e];
+                    si += tr[r] * plan.twIm[e] + ti[r] * plan.twRe[e];
+                }
+                const uint32_t e = static_cast<uint32_t>(j) * q * step;
+                const size_t o = k + static_cast<size_t>(s) * (static_cast<size_t>(p) * q + j);
+                yr[o] = sr * plan.twRe[e] - si * plan.twIm[e];
+                yi[o] = sr * plan.twIm[e] + si * plan.twRe[e];
+            }
+        }
+    }
+}
+
+} // namespace
+
+FftPlan makeFftPlan(uint32_t N) {
+    FftPlan plan;
+    plan.N = N;
+    uint32_t n = N;
+    while (n % 4 == 0) {
+        plan.radices.push_back(4);
+        n /= 4;
+    }
+    if (n % 2 == 0) {
+        plan.radices.push_back(2);
+        n /= 2;
+    }
+    for (uint32_t f = 3; f * f <= n; f += 2) {
+        while (n % f == 0) {
+            plan.radices.push_back(static_cast<int>(f));
+            n /= f;
+        }
+    }
+    if (n > 1) {
+        plan.radices.push_back(static_cast<int>(n));
+    }
+
+    const double pi = 3.14159265358979323846;
+    plan.twRe.resize(N);
+    plan.twIm.resize(N);
+    for (uint32_t k = 0; k < N; ++k) {
+        const double w = 2.0 * pi * k / N;
+        plan.twRe[k] = static_cast<float>(std::cos(w));
+        plan.twIm[k] = static_cast<float>(-std::sin(w));
+    }
+    return plan;
+}
+
+double fftCostInBins(const FftPlan& plan) {
+    double flops = 0.0;
+    for (int p : plan.radices) {
+        flops += radixFlops(p);
+    }
+    return flops / kernels().goertzelFlopsPerBin;
+}
+
+void fftPowers(
+    const float* data,
+    const FftPlan& plan,
+    const int* bins,
+    size_t count,
+    FftScratch& scratch,
+    float* powers
+) {
+    const uint32_t N = plan.N;
+    scratch.re0.assign(data, data + N);
+    scratch.im0.assign(N, 0.0f);
+    scratch.re1.resize(N);
+    scratch.im1.resize(N);
+
+    float* xr = scratch.re0.data();
+    float* xi = scratch.im0.data();
+    float* yr = scratch.re1.data();
+    float* yi = scratch.im1.data();
+    uint32_t n = N;
+    uint32_t s = 1;
+    for (int p : plan.radices) {
+        const uint32_t m = n / static_cast<uint32_t>(p);
+        const uint32_t step = N / n;
+        if (p == 2) {
+            radix2Stage(xr, xi, yr, yi, m, s, step, plan);
+        } else if (p == 4) {
+            radix4Stage(xr, xi, yr, yi, m, s, step, plan);
+        } else {
+            genericStage(xr, xi, yr, yi, p, m, s, step, plan, scratch);
+        }
+        std::swap(xr, yr);
+        std::swap(xi, yi);
+        n = m;
+        s *= static_cast<uint32_t>(p);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t b = static_cast<size_t>(bins[i]);
+        powers[i] = xr[b] * xr[b] + xi[b] * xi[b];
+    }
+}
+
+ChannelBank::ChannelBank(const std::vector<const DemodPlan*>& plans)
+    : plans_(plans), slots_(plans.size()) {
+    if (plans_.empty()) {
+        throw std::runtime_error("ChannelBank needs at least one demod plan");
+    }
+    for (const DemodPlan* p : plans_) {
+        if (p->N != plans_[0]->N) {
+            throw std::runtime_error("all channels must share the same symbol length N");
+        }
+    }
+    fft_ = makeFftPlan(plans_[0]->N);
+    setActive(std::vector<bool>(plans_.size(), false));
+}
+
+void ChannelBank::setActive(const std::vector<bool>& active) {
+    bins_.clear();
+    for (size_t c = 0; c < plans_.size(); ++c) {
+        if (active[c]) {
+            bins_.insert(bins_.end(), plans_[c]->bins.begin(), plans_[c]->bins.end());
+        }
+    }
+    std::sort(bins_.begin(), bins_.end());
+    bins_.erase(std::unique(bins_.begin(), bins_.end()), bins_.end());
+
+    for (size_t c = 0; c < plans_.size(); ++c) {
+        slots_[c].clear();
+        if (!active[c]) continue;
+        const DemodPlan& p = *plans_[c];
+        for (int b : p.bins) {
+            slots_[c].push_back(static_cast<size_t>(
+                std::lower_bound(bins_.begin(), bins_.end(), b) - bins_.begin()));
+        }
+    }
+    // 并集中每个 bin 的系数取自任一用到它的计划（同一 N 下同一 bin 的系数相同）
+    coeffs_.resize(bins_.size());
+    for (size_t c = 0; c < plans_.size(); ++c) {
+        for (size_t j = 0; j < slots_[c].size(); ++j) {
+            coeffs_[slots_[c][j]] = plans_[c]->coeffs[j];
+        }
+    }
+    powers_.resize(bins_.size());
+    useFft_ = static_cast<double>(bins_.size()) > fftCostInBins(fft_);
+}
+
+void ChannelBank::compute(const float* frame) {
+    if (bins_.empty()) return;
+    if (useFft_) {
+        fftPowers(frame, fft_, bins_.data(), bins_.size(), fftScratch_, powers_.data());
+    } else {
+        goertzelBank(frame, fft_.N, coeffs_, scratch_);
+        std::copy(scratch_.powers.begin(), scratch_.powers.end(), powers_.begin());
+    }
+}
+
+void ChannelBank::detect(size_t c, int* symbolsOut) {
+    const std::vector<size_t>& slots = slots_[c];
+    gather_.resize(slots.size());
+    for (size_t j = 0; j < slots.size(); ++j) {
+        gather_[j] = powers_[slots[j]];
+    }
+    pickTones(gather_.data(), *plans_[c], symbolsOut);
+}
@@ -0,0 +1,77 @@
+// src/channelizer.h
+#pragma once
+#include "demod.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 多发送端共享频谱：同一符号长度 N 下的多份解调计划（每个发送端一组 bin），
+// 同一个窗口的能量只算一次，各计划从中取自己的 bin 判决
+//
+// 所有计划的 bin 取并集去重，两种算法按估计代价取小：
+//   Goertzel  只算并集中的 bin，代价 ∝ N * 并集大小（发送端少时与单路解调相同）
+//   FFT       一次混合基 FFT 得到全部 N/2 个 bin，代价 ∝ N * Σ基数，与发送端数无关
+// 发送端多了之后单窗口的频谱代价有上界，之后每多一路只多一次查表和判决
+
+// 混合基复数 FFT 计划（Stockham 自动排序，输出按自然顺序，不需要位反转）
+struct FftPlan {
+    uint32_t           N = 0;
+    std::vector<int>   radices;      // N 的因子分解：先 4、2，再从小到大的奇素数
+    std::vector<float> twRe;         // cos(2πk/N)，k = 0..N-1
+    std::vector<float> twIm;         // -sin(2πk/N)
+};
+
+// 两组 ping-pong 缓冲 + 通用基数蝶形的临时量
+struct FftScratch {
+    std::vector<float> re0, im0, re1, im1;
+    std::vector<float> tmpRe, tmpIm;
+};
+
+FftPlan makeFftPlan(uint32_t N);
+
+// 一次 FFT 的代价，折算成 Goertzel 滤波器组中的 bin 数（用于选择算法）
+double fftCostInBins(const FftPlan& plan);
+
+// 实数窗口 data[0..N) 的 DFT，powers[i] = |X[bins[i]]|^2（与 Goertzel 能量同一刻度）
+void fftPowers(
+    const float* data,
+    const FftPlan& plan,
+    const int* bins,
+    size_t count,
+    FftScratch& scratch,
+    float* powers
+);
+
+// 各计划共用的频谱扫描，带自己的缓冲（每个解码线程各一份）
+class ChannelBank {
+public:
+    // plans 的 N 必须相同，否则抛 std::runtime_error；计划在 ChannelBank 生命周期内须保持有效。
+    // 构造后没有活动计划（unionBins() 为 0），由 setActive 逐个加入
+    explicit ChannelBank(const std::vector<const DemodPlan*>& plans);
+
+    // 只有 active[c] 为 true 的计划参与之后的 compute（还在前导中或已结束的不算），
+    // 按新的并集重新选择算法
+    void setActive(const std::vector<bool>& active);
+
+    bool   usingFft() const { return useFft_; }
+    size_t unionBins() const { return bins_.size(); }
+
+    // 对一个已预处理（去 DC + Hann 窗）的窗口算出所有活动计划的 bin 能量
+    void compute(const float* frame);
+
+    // 计划 c 各子带的判决音序号（c 须为活动计划，在 compute 之后调用）
+    void detect(size_t c, int* symbolsOut);
+
+private:
+    std::vector<const DemodPlan*>    plans_;
+    std::vector<std::vector<size_t>> slots_;   // slots_[c][j]：计划 c 第 j 个 bin 在并集中的下标
+    std::vector<int>                 bins_;    // 活动计划 bin 的并集（升序）
+    std::vector<float>               coeffs_;  // 并集对应的 Goertzel 系数
+    std::vector<float>               powers_;  // 并集能量
+    std::vector<float>               gather_;  // 单个计划的能量（按 coeffs 顺序）
+    FftPlan                          fft_;
+    FftScratch                       fftScratch_;
+    DemodScratch                     scratch_;
+    bool                             useFft_ = false;
+};
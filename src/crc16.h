@@ -1,19 +1,34 @@
+// src/crc16.h
 #pragma once
+#include <array>
 #include <cstdint>
 #include <cstddef>
 
+namespace crc16_detail {
+
+// 按字节查表：table[b] = 高字节为 b、其余为 0 时移出 8 位后的余式，编译期生成
+constexpr std::array<uint16_t, 256> makeTable() {
+    std::array<uint16_t, 256> table{};
+    for (int b = 0; b < 256; ++b) {
+        uint16_t crc = static_cast<uint16_t>(b << 8);
+        for (int j = 0; j < 8; ++j) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+        table[b] = crc;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint16_t, 256> TABLE = makeTable();
+
+} // namespace crc16_detail
+
 // CRC-16-CCITT (poly 0x1021, init 0xFFFF, no reflection)
 inline uint16_t crc16_ccitt(const uint8_t* data, size_t len) {
     uint16_t crc = 0xFFFF;
     for (size_t i = 0; i < len; ++i) {
-        crc ^= static_cast<uint16_t>(data[i]) << 8;
-        for (int j = 0; j < 8; ++j) {
-            if (crc & 0x8000) {
-                crc = static_cast<uint16_t>((crc << 1) ^ 0x1021);
-            } else {
-                crc <<= 1;
-            }
-        }
+        crc = static_cast<uint16_t>((crc << 8) ^ crc16_detail::TABLE[(crc >> 8) ^ data[i]]);
     }
     return crc;
-}
\ No newline at end of file
+}
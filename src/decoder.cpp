@@ -1,261 +1,1605 @@
 // src/decoder.cpp
 #include "decoder.h"
 #include "wav_io.h"
+#include "async_io.h"
+#include "channelizer.h"
+#include "crc16.h"
 #include "fec.h"
 #include "frame.h"
+#include "frame_index.h"
+#include "lz.h"
+#include "rate_mode.h"
+#include "sample_source.h"
+#include "spsc_ring.h"
+#include "telemetry.h"
 
 #include <vector>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <cmath>
 #include <stdexcept>
 #include <string>
 #include <array>
-#include <algorithm> // for std::min
+#include <memory>
+#include <algorithm> // for std::min, std::minmax_element
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+bool buildDecoderPlan(const DecodeParams& params, DecoderPlan& plan) {
+    if (params.adaptive && params.subbands != 1) {
+        std::cerr << "Adaptive rate modes require --subbands 1\n";
+        return false;
+    }
+    try {
+        plan.demod = makeDemodPlan(params);
+        plan.modes.clear();
+        if (params.adaptive) {
+            plan.header = makeDemodPlan(modeHeaderParams(params));
+            for (int m = 0; m < RATE_MODE_COUNT; ++m) {
+                plan.modes.push_back(makeDemodPlan(applyRateMode(params, m)));
+            }
+        }
+        plan.modesQ15.clear();
+        if (params.fixedPoint) {
+            plan.demodQ15 = makeDemodPlanQ15(plan.demod);
+            if (params.adaptive) {
+                plan.headerQ15 = makeDemodPlanQ15(plan.header);
+                for (const DemodPlan& mp : plan.modes) {
+                    plan.modesQ15.push_back(makeDemodPlanQ15(mp));
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error in makeDemodPlan: " << e.what() << "\n";
+        return false;
+    }
+    plan.params = params;
+    return true;
+}
+
+bool decodeWavToFile(
+    const std::string& inputWavPath,
+    const std::string& outputBinPath,
+    const DecodeParams& params
+) {
+    DecoderPlan plan;
+    if (!buildDecoderPlan(params, plan)) {
+        return false;
+    }
+    return decodeWavToFile(inputWavPath, outputBinPath, plan);
+}
 
 namespace {
 
-constexpr float PI_F = 3.14159265358979323846f;
+constexpr size_t FRAME_HEADER_BYTES = 5;    // marker + len + seq
+constexpr size_t FRAME_CRC_BYTES    = 2;
+constexpr size_t PREFIX_TRACEBACK   = 24;   // 前缀 Viterbi 多解的步数，保证帧头 40 bit 可靠
 
-struct SymbolShape {
-    uint32_t N; // 每个符号的采样点数
-};
+} // namespace
+
+size_t frameCodedBits(size_t payloadLen, bool fec, bool tailBiting) {
+    const size_t infoBits = (FRAME_HEADER_BYTES + payloadLen + FRAME_CRC_BYTES) * 8;
+    return fec ? 2 * (infoBits + (tailBiting ? 0 : 2)) : infoBits;
+}
+
+namespace {
+
+// 解出帧开头 bytes 个字节所需的编码比特数
+size_t prefixCodedBits(size_t bytes, bool fec) {
+    const size_t infoBits = bytes * 8;
+    return fec ? 2 * (infoBits + PREFIX_TRACEBACK) : infoBits;
+}
+
+// 从编码比特流开头解出帧的前 bytes 个字节（不校验 CRC）；比特不够时返回 false
+bool peekFrameBytes(const uint8_t* codedBits, size_t count, bool fec, bool tailBiting,
+                    DecodeWorkspace& ws, size_t bytes, uint8_t* out) {
+    const size_t need = prefixCodedBits(bytes, fec);
+    if (count < need) {
+        return false;
+    }
+    const uint8_t* bits = codedBits;
+    if (fec) {
+        // 截断 Viterbi：不要求终点回到状态 0，只取前 bytes * 8 bit
+        // 咬尾码的起点取决于帧末比特，前缀解码时视为未知
+        const ConvTermination term = tailBiting ? ConvTermination::TailBitingPrefix : ConvTermination::Prefix;
+        if (!convDecode(codedBits, need, ws.survivors, ws.bits, term)) {
+            return false;
+        }
+        bits = ws.bits.data();
+    }
 
-SymbolShape computeSymbolShape(uint32_t sampleRate, double symbolDurationSec) {
-    uint32_t N = static_cast<uint32_t>(sampleRate * symbolDurationSec);
-    if (N == 0) {
-        throw std::runtime_error("symbolDurationSec too small for given sampleRate");
+    std::fill(out, out + bytes, 0);
+    for (size_t i = 0; i < bytes * 8; ++i) {
+        out[i / 8] = static_cast<uint8_t>((out[i / 8] << 1) | (bits[i] & 0x1));
     }
-    return { N };
+    return true;
 }
 
-// Goertzel 配置（DFT bin 对齐版本）
-struct GoertzelConfig {
-    float coeff;   // 2*cos(omega)
-    uint32_t N;    // 窗口长度
+} // namespace
+
+size_t framePrefixCodedBits(bool fec) {
+    return prefixCodedBits(FRAME_HEADER_BYTES, fec);
+}
+
+bool peekFrameHeader(const uint8_t* codedBits, size_t count, bool fec, bool tailBiting,
+                     DecodeWorkspace& ws, size_t& payloadLen) {
+    uint8_t hdr[FRAME_HEADER_BYTES];
+    if (!peekFrameBytes(codedBits, count, fec, tailBiting, ws, sizeof(hdr), hdr)) {
+        return false;
+    }
+    if (hdr[0] != 0xA5 || hdr[1] != 0x5A) {
+        return false;
+    }
+    payloadLen = static_cast<size_t>(hdr[2]) | (static_cast<size_t>(hdr[3]) << 8);
+    return true;
+}
+
+namespace {
+
+// 内存中的样本源，接口与 SampleSource 的 read/skip 一致
+class MemorySource {
+public:
+    MemorySource(const float* samples, size_t count) : p_(samples), left_(count) {}
+
+    uint64_t totalSamples() const { return left_; }
+    bool lengthKnown() const { return true; }
+
+    size_t read(float* out, size_t count) {
+        count = std::min(count, left_);
+        std::copy(p_, p_ + count, out);
+        p_ += count;
+        left_ -= count;
+        return count;
+    }
+
+    // 内存中已是 float 样本（scan / analyze 的缓冲），定点路径只能取整
+    size_t read(int16_t* out, size_t count) {
+        count = std::min(count, left_);
+        floatToInt16(p_, out, static_cast<uint32_t>(count));
+        p_ += count;
+        left_ -= count;
+        return count;
+    }
+
+    uint64_t skip(uint64_t count) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(count, left_));
+        p_ += n;
+        left_ -= n;
+        return n;
+    }
+
+private:
+    const float* p_;
+    size_t left_;
 };
 
-// 使用 bin index 直接计算 ω = 2π * bin / N
-GoertzelConfig makeGoertzelConfigFromBin(
-    int binIndex,
-    uint32_t N
+// 记录一个符号窗口各子带的判决：次强音、本子带其余音能量的中位数作为噪声底
+template <typename Power>
+void recordSymbolTelemetry(
+    TelemetryWriter& tlm,
+    uint32_t symbol,
+    const Power* powers,
+    int K,
+    int A,
+    const int* symbols,
+    float peak
 ) {
-    if (binIndex <= 0 || binIndex >= static_cast<int>(N / 2)) {
-        throw std::runtime_error("Invalid bin index for Goertzel (must be in (0, N/2))");
+    std::array<float, 16> others{};
+    for (int band = 0; band < K; ++band) {
+        const Power* p = powers + static_cast<size_t>(band) * A;
+        const int best = symbols[band];
+        int second = -1;
+        int n = 0;
+        for (int i = 0; i < A; ++i) {
+            if (i == best) continue;
+            if (second < 0 || p[i] > p[second]) second = i;
+            others[n++] = static_cast<float>(p[i]);
+        }
+
+        SymbolTelemetry s;
+        s.symbol = symbol;
+        s.band = static_cast<uint16_t>(band);
+        s.best = static_cast<uint8_t>(best);
+        s.bestPower = static_cast<float>(p[best]);
+        if (n > 0) {
+            std::nth_element(others.begin(), others.begin() + n / 2, others.begin() + n);
+            s.second = static_cast<uint8_t>(second);
+            s.secondPower = static_cast<float>(p[second]);
+            s.noiseFloor = others[n / 2];
+        }
+        s.peak = peak;
+        tlm.addSymbol(s);
+    }
+}
+
+// 各子带判决的音序号还原为 K * toneBits 个 bit 追加到 bitsOut（顺序与编码端一致：子带 0..K-1，每个高位在前）
+void appendSymbolBits(const int* symbols, int K, int toneBits, std::vector<uint8_t>& bitsOut) {
+    for (int band = 0; band < K; ++band) {
+        for (int bitPos = toneBits - 1; bitPos >= 0; --bitPos) {
+            int bit = (symbols[band] >> bitPos) & 0x1;
+            bitsOut.push_back(static_cast<uint8_t>(bit));
+        }
     }
+}
 
-    GoertzelConfig cfg{};
-    cfg.N = N;
+// 读一个符号窗口：定点路径直接读 int16 到 ws.frameQ15（16-bit PCM 不经浮点），否则读到 ws.frame
+template <typename Source>
+bool readWindow(Source& source, uint32_t N, bool fixedPoint, DecodeWorkspace& ws) {
+    if (fixedPoint) {
+        ws.frameQ15.resize(N);
+        return source.read(ws.frameQ15.data(), N) == N;
+    }
+    ws.frame.resize(N);
+    return source.read(ws.frame.data(), N) == N;
+}
 
-    float omega = 2.0f * PI_F *
-                  static_cast<float>(binIndex) /
-                  static_cast<float>(N);
+// 对 readWindow 读入的一个符号窗口做 DC 去除 + Hann 窗并判决各子带音序号，
+// 还原 K * toneBits 个 bit 追加到 bitsOut（顺序与编码端一致：子带 0..K-1，每个高位在前）
+// demodQ15 非空时走定点路径（窗口在 ws.frameQ15 中）
+void demodWindow(
+    const DemodPlan& demod,
+    const DemodPlanQ15* demodQ15,
+    DecodeWorkspace& ws,
+    std::vector<uint8_t>& bitsOut
+) {
+    const int K = demod.subbands;
+    const int toneBits = demod.toneBits;
+    ws.symbols.resize(static_cast<size_t>(K));
 
-    cfg.coeff = 2.0f * std::cos(omega);
-    return cfg;
+    // 遥测：预处理会就地改写窗口，先取原始峰值
+    float peak = 0.0f;
+    if (ws.telemetry) {
+        for (uint32_t i = 0; i < demod.N; ++i) {
+            peak = std::max(peak, demodQ15 ? std::fabs(static_cast<float>(ws.frameQ15[i])) : std::fabs(ws.frame[i]));
+        }
+    }
+
+    if (demodQ15) {
+        preprocessFrameQ15(ws.frameQ15.data(), *demodQ15);
+        detectSymbolIndicesQ15(ws.frameQ15.data(), *demodQ15, ws.scratchQ15, ws.symbols.data());
+    } else {
+        preprocessFrame(ws.frame.data(), demod);
+        detectSymbolIndices(ws.frame.data(), demod, ws.scratch, ws.symbols.data());
+    }
+
+    if (ws.telemetry) {
+        const uint32_t symbol = static_cast<uint32_t>(bitsOut.size() / (static_cast<size_t>(K) * toneBits));
+        if (demodQ15) {
+            recordSymbolTelemetry(*ws.telemetry, symbol, ws.scratchQ15.powers.data(), K,
+                                  demod.tonesPerBand, ws.symbols.data(), peak);
+        } else {
+            recordSymbolTelemetry(*ws.telemetry, symbol, ws.scratch.powers.data(), K,
+                                  demod.tonesPerBand, ws.symbols.data(), peak);
+        }
+    }
+
+    appendSymbolBits(ws.symbols.data(), K, toneBits, bitsOut);
 }
 
-float goertzelPower(
-    const int16_t* data,
-    const GoertzelConfig& cfg
+// CRC 通过后帧内容即为真值：重新编码得到发送的音序号，与实际判决逐个对比
+void fillConfusion(
+    const uint8_t* frameBytes,
+    size_t frameLen,
+    bool useFec,
+    bool tailBiting,
+    const DemodPlan& demod,
+    const std::vector<uint8_t>& codedBits,
+    FrameTelemetry& f
 ) {
-    float s_prev  = 0.0f;
-    float s_prev2 = 0.0f;
-    const uint32_t N = cfg.N;
+    std::vector<uint8_t> bits;
+    bytesToBits(std::vector<uint8_t>(frameBytes, frameBytes + frameLen), bits);
+    std::vector<uint8_t> sent;
+    if (useFec && tailBiting) {
+        convEncodeTailBiting(bits, sent);
+    } else if (useFec) {
+        convEncode(bits, sent);
+    } else {
+        sent.swap(bits);
+    }
+
+    const int toneBits = demod.toneBits;
+    const int A = demod.tonesPerBand;
+    f.alphabet = A;
+    f.confusion.assign(static_cast<size_t>(A) * A, 0);
+    const size_t groups = codedBits.size() / static_cast<size_t>(toneBits);
+    for (size_t g = 0; g < groups; ++g) {
+        int t = 0;
+        int d = 0;
+        for (int k = 0; k < toneBits; ++k) {
+            const size_t i = g * toneBits + k;
+            // 编码端按符号补齐的比特为 0
+            t = (t << 1) | (i < sent.size() ? (sent[i] & 0x1) : 0);
+            d = (d << 1) | (codedBits[i] & 0x1);
+        }
+        ++f.confusion[static_cast<size_t>(t) * A + d];
+    }
+}
+
+// 数据段的解调方式：固定参数时为 plan.demod，自适应模式下由模式头决定
+struct DataLayout {
+    const DemodPlan*    demod      = nullptr;
+    const DemodPlanQ15* demodQ15   = nullptr;   // 仅定点路径
+    bool                fec        = true;
+    bool                tailBiting = false;     // 仅 fec 时有效
+    int                 modeId     = -1;
+};
 
-    for (uint32_t i = 0; i < N; ++i) {
-        float x = static_cast<float>(data[i]);
-        float s = x + cfg.coeff * s_prev - s_prev2;
-        s_prev2 = s_prev;
-        s_prev  = s;
+DataLayout dataLayout(const DecoderPlan& plan, int modeId) {
+    DataLayout layout;
+    layout.modeId = modeId;
+    layout.tailBiting = plan.params.tailBiting;
+    if (modeId < 0) {
+        layout.demod = &plan.demod;
+        layout.fec   = plan.params.fec;
+        if (plan.params.fixedPoint) layout.demodQ15 = &plan.demodQ15;
+    } else {
+        layout.demod = &plan.modes[modeId];
+        layout.fec   = rateMode(modeId).fec;
+        if (plan.params.fixedPoint) layout.demodQ15 = &plan.modesQ15[modeId];
     }
+    return layout;
+}
 
-    float power = s_prev2 * s_prev2 + s_prev * s_prev - cfg.coeff * s_prev * s_prev2;
-    return power;
+// 前导 + 模式头之后、第一帧之前的样本数
+uint64_t streamHeaderSamples(const DecoderPlan& plan) {
+    uint64_t n = static_cast<uint64_t>(plan.params.syncSymbols) * plan.demod.N;
+    if (plan.params.adaptive) {
+        n += static_cast<uint64_t>(MODE_HEADER_SYMBOLS) * plan.header.N;
+    }
+    return n;
 }
 
-// 简单预处理：去 DC + Hann 窗
-void preprocessFrame(std::vector<int16_t>& frame) {
-    const uint32_t N = static_cast<uint32_t>(frame.size());
-    if (N == 0) return;
+// 一帧的解码结果：data 指向 ws 内部（已去掉扩展头、已解压），在下一次解码前有效
+struct FrameResult {
+    const uint8_t* data     = nullptr;
+    size_t         size     = 0;
+    uint8_t        seq      = 0;
+    bool           extended = false;   // 多帧流中的一帧，ext 有效
+    FrameExtHeader ext;
+};
+
+// 跳过前导，自适应模式下读取模式头并确定数据段的解调方式
+// status 为进度信息的输出流（解码结果写 stdout 时为 stderr）
+template <typename Source>
+bool readStreamHeader(Source& source, const DecoderPlan& plan, DecodeWorkspace& ws, DataLayout& layout,
+                      std::ostream& status) {
+    const DecodeParams& params = plan.params;
+    const DemodPlan& demod = plan.demod;
 
-    // 去直流
-    float mean = 0.0f;
-    for (uint32_t i = 0; i < N; ++i) {
-        mean += static_cast<float>(frame[i]);
+    // 2. 符号形状（N 与 Goertzel 系数已在 plan 中预计算）
+    //    流式输入（长度未知）时跳过长度预检查，读到 EOF 为止
+    const bool lengthKnown = source.lengthKnown();
+    uint64_t numSamples = lengthKnown ? source.totalSamples() : 0;
+    uint64_t syncSamples = static_cast<uint64_t>(params.syncSymbols) * demod.N;
+    if (lengthKnown && numSamples / demod.N <= static_cast<uint64_t>(params.syncSymbols)) {
+        std::cerr << "Not enough symbols for sync and data.\n";
+        return false;
     }
-    mean /= static_cast<float>(N);
 
-    for (uint32_t i = 0; i < N; ++i) {
-        float x = static_cast<float>(frame[i]) - mean;
+    // 3. 前 syncSymbols 个符号作为同步，扔掉
+    if (source.skip(syncSamples) != syncSamples) {
+        std::cerr << "Unexpected end of WAV data.\n";
+        return false;
+    }
 
-        // Hann 窗
-        float w = 0.5f - 0.5f * std::cos(2.0f * PI_F * static_cast<float>(i) /
-                                         static_cast<float>(N - 1));
-        x *= w;
+    layout = dataLayout(plan, -1);
+    if (!params.adaptive) {
+        return true;
+    }
 
-        // 写回 int16（幅度缩放对 Goertzel 判 argmax 不重要）
-        if (x > 32767.0f) x = 32767.0f;
-        if (x < -32768.0f) x = -32768.0f;
-        frame[i] = static_cast<int16_t>(std::lrint(x));
+    // 3b. 自适应模式：读取模式头，切换到对应模式的解调计划与码率
+    //     定点路径：直接读 int16 窗口，全部为整数运算
+    std::vector<float>& frame = ws.frame;
+    std::vector<int16_t>& frameQ15 = ws.frameQ15;
+    const DemodPlan& hp = plan.header;
+    std::array<std::array<float, 4>, MODE_HEADER_DIGITS> digitPowers{};
+    for (int k = 0; k < MODE_HEADER_SYMBOLS; ++k) {
+        if (!readWindow(source, hp.N, params.fixedPoint, ws)) {
+            std::cerr << "Unexpected end of WAV data in mode header.\n";
+            return false;
+        }
+        if (params.fixedPoint) {
+            preprocessFrameQ15(frameQ15.data(), plan.headerQ15);
+            goertzelBankQ15(frameQ15.data(), plan.headerQ15, ws.scratchQ15);
+            for (int t = 0; t < 4; ++t) {
+                digitPowers[k % MODE_HEADER_DIGITS][t] += static_cast<float>(ws.scratchQ15.powers[t]);
+            }
+        } else {
+            preprocessFrame(frame.data(), hp);
+            goertzelBank(frame.data(), hp.N, hp.coeffs, ws.scratch);
+            for (int t = 0; t < 4; ++t) {
+                digitPowers[k % MODE_HEADER_DIGITS][t] += ws.scratch.powers[t];
+            }
+        }
     }
+
+    int modeId = parseModeHeader(digitPowers);
+    if (modeId < 0) {
+        std::cerr << "Mode header check failed.\n";
+        return false;
+    }
+    layout = dataLayout(plan, modeId);
+    if (params.verbose) {
+        status << "Rate mode " << modeId << ": " << rateMode(modeId).name << "\n";
+    }
+    return true;
 }
 
-// 对一个符号窗口，判决其对应的 16-FSK 频率 index (0..15)
-int detectSymbolIndex(
-    const int16_t* frame,
-    const std::array<GoertzelConfig, 16>& cfgs
-) {
-    float bestPower = -1.0f;
-    int bestIdx = 0;
-    for (int i = 0; i < 16; ++i) {
-        float p = goertzelPower(frame, cfgs[i]);
-        if (p > bestPower) {
-            bestPower = p;
-            bestIdx = i;
+// 4. 从当前位置（符号边界）解调一帧 -> codedBits（FEC 前的 bit 流）
+//    收到帧头前缀后即可算出整帧的编码比特数，读够就停：管道输入不必等 EOF，
+//    缓冲上限为一帧，数据段之后的静音或下一帧也不会混进 Viterbi。
+//    帧头不符时读到 EOF（stopOnBadHeader 时立即返回）；frameBits 为帧头给出的编码比特数，帧头不符时为 0。
+//    一个完整符号都没读到时返回 false
+template <typename Source>
+bool demodFrame(Source& source, const DataLayout& layout, DecodeWorkspace& ws,
+                std::vector<uint8_t>& codedBits, size_t& frameBits, bool stopOnBadHeader = false) {
+    const DemodPlan& demod = *layout.demod;
+    const bool useFec = layout.fec;
+    const bool tailBiting = useFec && layout.tailBiting;
+
+    const uint32_t N = demod.N;
+    const bool fixedPoint = layout.demodQ15 != nullptr;
+    const size_t bitsPerSymbol = static_cast<size_t>(demod.subbands) *
+                                 static_cast<size_t>(demod.toneBits);
+
+    codedBits.clear();
+    frameBits = 0;
+
+    const size_t prefixBits = framePrefixCodedBits(useFec);
+    bool prefixChecked = false;
+    size_t neededBits = SIZE_MAX;
+    while (codedBits.size() < neededBits && readWindow(source, N, fixedPoint, ws)) {
+        demodWindow(demod, layout.demodQ15, ws, codedBits);
+
+        if (!prefixChecked && codedBits.size() >= prefixBits) {
+            prefixChecked = true;
+            size_t payloadLen = 0;
+            if (peekFrameHeader(codedBits.data(), codedBits.size(), useFec, tailBiting, ws, payloadLen)) {
+                frameBits = frameCodedBits(payloadLen, useFec, tailBiting);
+                neededBits = (frameBits + bitsPerSymbol - 1) / bitsPerSymbol * bitsPerSymbol;
+                codedBits.reserve(neededBits);
+            } else if (stopOnBadHeader) {
+                break;
+            }
         }
     }
-    return bestIdx;
+    return !codedBits.empty();
 }
 
-} // namespace
+// 5..6. 卷积 Viterbi 解码 -> 原始帧 bit 流（未编码模式直接使用）-> frameBytes
+bool fecDecodeFrame(const DataLayout& layout, const std::vector<uint8_t>& codedBits, size_t frameBits,
+                    DecodeWorkspace& ws, std::vector<uint8_t>& frameBytes, FrameTelemetry& ftlm) {
+    const bool useFec = layout.fec;
+    const bool tailBiting = useFec && layout.tailBiting;
 
-bool decodeWavToFile(
-    const std::string& inputWavPath,
-    const std::string& outputBinPath,
-    const DecodeParams& params
-) {
-    std::ifstream ifs(inputWavPath, std::ios::binary);
-    if (!ifs) {
-        std::cerr << "Failed to open WAV for reading: " << inputWavPath << "\n";
+    //    零尾码后面按符号补齐的 0 不改变状态，可以一起解；咬尾码是一个环，只能解帧本身的比特
+    const std::vector<uint8_t>* bits = &codedBits;
+    if (useFec) {
+        uint32_t pathMetric = 0;
+        const size_t count = (tailBiting && frameBits > 0) ? std::min(frameBits, codedBits.size())
+                                                           : codedBits.size();
+        const ConvTermination term = tailBiting ? ConvTermination::TailBiting : ConvTermination::Zero;
+        if (!convDecode(codedBits.data(), count, ws.survivors, ws.bits, term, &pathMetric)) {
+            std::cerr << "Convolutional decode failed.\n";
+            return false;
+        }
+        ftlm.pathMetric = pathMetric;
+        bits = &ws.bits;
+    }
+    bitsToBytes(*bits, frameBytes);
+    return true;
+}
+
+// 7..8. 帧解析（marker/length/CRC）、去掉扩展头、解压；out.data 指向 frameBytes 或 ws.unpacked 内部
+//       ftlm 非空时在 CRC 通过后补全遥测（混淆矩阵需要 codedBits）
+bool unpackFrame(const DataLayout& layout, const std::vector<uint8_t>& frameBytes,
+                 const std::vector<uint8_t>& codedBits, DecodeWorkspace& ws, FrameResult& out,
+                 FrameTelemetry* ftlm) {
+    out = FrameResult{};
+
+    // 7. payload 直接指向 frameBytes 内部
+    const uint8_t* payload = nullptr;
+    size_t payloadLen = 0;
+    uint8_t seq = 0;
+    if (!parseFrame(frameBytes.data(), frameBytes.size(), payload, payloadLen, seq)) {
+        std::cerr << "Frame parse failed (marker or CRC error).\n";
         return false;
     }
+    if (ftlm) {
+        ftlm->crcOk = true;
+        ftlm->payloadLen = static_cast<uint32_t>(payloadLen);
+        fillConfusion(frameBytes.data(), FRAME_HEADER_BYTES + payloadLen + FRAME_CRC_BYTES,
+                      layout.fec, layout.fec && layout.tailBiting, *layout.demod, codedBits, *ftlm);
+    }
 
-    // 1. 读 WAV 头
-    WavHeader header{};
-    ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
-    if (!ifs) {
-        std::cerr << "Failed to read WAV header\n";
+    // 7b. 多帧流：去掉扩展头
+    if (seq & FRAME_FLAG_EXTENDED) {
+        if (!getFrameExtHeader(payload, payloadLen, out.ext)) {
+            std::cerr << "Truncated extended frame header.\n";
+            return false;
+        }
+        out.extended = true;
+        payload += FRAME_EXT_BYTES;
+        payloadLen -= FRAME_EXT_BYTES;
+    }
+
+    // 8. 帧头带压缩标志时解压到 ws.unpacked
+    if (seq & FRAME_FLAG_COMPRESSED) {
+        if (!lzDecompress(payload, payloadLen, ws.unpacked)) {
+            std::cerr << "Payload decompression failed.\n";
+            return false;
+        }
+        payload = ws.unpacked.data();
+        payloadLen = ws.unpacked.size();
+    }
+
+    out.data = payload;
+    out.size = payloadLen;
+    out.seq  = seq;
+    return true;
+}
+
+// ws.codedBits 中已解调的一帧（frameBits 为帧头给出的编码比特数，帧头不符时为 0）：
+// FEC -> 帧解析 -> 解压，并写帧遥测
+bool finishFrame(const DataLayout& layout, DecodeWorkspace& ws, size_t frameBits, FrameResult& out) {
+    out = FrameResult{};
+
+    // 帧汇总：不论成败都写进遥测（解码失败时正是最需要它的时候）
+    const size_t bitsPerSymbol = static_cast<size_t>(layout.demod->subbands) *
+                                 static_cast<size_t>(layout.demod->toneBits);
+    FrameTelemetry ftlm;
+    ftlm.headerOk = frameBits > 0;
+    ftlm.codedBits = ws.codedBits.size();
+    ftlm.dataSymbols = ws.codedBits.size() / bitsPerSymbol;
+
+    const bool ok = fecDecodeFrame(layout, ws.codedBits, frameBits, ws, ws.frameBytes, ftlm) &&
+                    unpackFrame(layout, ws.frameBytes, ws.codedBits, ws, out,
+                                ws.telemetry ? &ftlm : nullptr);
+    // CRC 之后的失败（扩展头、解压）不影响帧汇总
+    if (ws.telemetry) {
+        ws.telemetry->finishFrame(ftlm);
+    }
+    return ok;
+}
+
+// 从当前位置（符号边界）解出一帧：解调 -> FEC -> 帧解析 -> 解压，缓冲全部取自 ws
+template <typename Source>
+bool decodeFrame(Source& source, const DataLayout& layout, DecodeWorkspace& ws, FrameResult& out) {
+    out = FrameResult{};
+    size_t frameBits = 0;
+    if (!demodFrame(source, layout, ws, ws.codedBits, frameBits)) {
+        std::cerr << "No coded bits decoded from FSK.\n";
         return false;
     }
+    return finishFrame(layout, ws, frameBits, out);
+}
 
-    if (std::string(header.riff, 4) != "RIFF" ||
-        std::string(header.wave, 4) != "WAVE" ||
-        std::string(header.fmt, 4)  != "fmt " ||
-        std::string(header.data, 4) != "data") {
-        std::cerr << "Invalid WAV format\n";
+// 多帧流：按扩展头中的偏移把一帧接到 stream 后面，偏移 / 总长与已收到的不符时打印原因并返回 false
+bool appendStreamFrame(const FrameResult& fr, uint64_t total, std::vector<uint8_t>& stream) {
+    if (fr.ext.total != total || fr.ext.offset != stream.size() || fr.size > total - stream.size()) {
+        std::cerr << "Frame out of sequence at byte " << stream.size()
+                  << " (frame offset " << fr.ext.offset << ").\n";
         return false;
     }
+    stream.insert(stream.end(), fr.data, fr.data + fr.size);
+    return true;
+}
+
+// 前导之后的全部流程：模式头 -> 逐帧解码；多帧流按扩展头中的偏移拼接到 ws.stream
+template <typename Source>
+bool decodeFromSource(Source& source, const DecoderPlan& plan, DecodeWorkspace& ws, PayloadView& out,
+                      std::ostream& status) {
+    out = PayloadView{};
 
-    if (header.audioFormat != 1 || header.numChannels != 1 || header.bitsPerSample != 16) {
-        std::cerr << "Only PCM mono 16-bit supported\n";
+    DataLayout layout;
+    if (!readStreamHeader(source, plan, ws, layout, status)) {
         return false;
     }
 
-    if (header.sampleRate != params.sampleRate) {
-        std::cerr << "Sample rate mismatch. Expected " << params.sampleRate
-                  << ", got " << header.sampleRate << "\n";
+    FrameResult fr;
+    if (!decodeFrame(source, layout, ws, fr)) {
         return false;
     }
+    const uint8_t firstSeq = fr.seq;
+    if (!fr.extended) {
+        out.data = fr.data;
+        out.size = fr.size;
+        out.seq  = firstSeq;
+        return true;
+    }
 
-    // 2. 符号形状
-    SymbolShape shape;
-    try {
-        shape = computeSymbolShape(params.sampleRate, params.symbolDurationSec);
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << "\n";
+    const uint64_t total = fr.ext.total;
+    ws.stream.clear();
+    for (;;) {
+        if (!appendStreamFrame(fr, total, ws.stream)) {
+            return false;
+        }
+        if (ws.stream.size() == total) {
+            break;
+        }
+        if (!decodeFrame(source, layout, ws, fr) || !fr.extended) {
+            std::cerr << "Stream ended after " << ws.stream.size() << " of " << total << " bytes.\n";
+            return false;
+        }
+    }
+
+    out.data = ws.stream.data();
+    out.size = ws.stream.size();
+    out.seq  = firstSeq;
+    return true;
+}
+
+// 随机访问只支持原采样率：重采样器有状态，seek 之后无法接续
+bool checkSeekable(const std::string& inputWavPath, const WavReader& reader, const DecodeParams& params) {
+    if (inputWavPath == "-") {
+        std::cerr << "Random access needs a seekable input file, not stdin.\n";
         return false;
     }
+    if (reader.info().sampleRate != params.sampleRate) {
+        std::cerr << "Random access does not support resampling (file is "
+                  << reader.info().sampleRate << " Hz, --sr " << params.sampleRate << ").\n";
+        return false;
+    }
+    return true;
+}
 
-    uint64_t numSamples = header.subchunk2Size / (header.bitsPerSample / 8);
-    if (shape.N == 0) {
-        std::cerr << "Invalid symbol shape.\n";
+// 从第一帧开始逐帧读帧头：只解调前缀所需的几个符号，按帧长直接 seek 到下一帧
+bool scanFrameIndex(WavReader& reader, const DecoderPlan& plan, DecodeWorkspace& ws, FrameIndex& index,
+                    std::ostream& status) {
+    // 扫描时解调的只是帧头前缀，不写遥测
+    TelemetryWriter* const savedTelemetry = ws.telemetry;
+    ws.telemetry = nullptr;
+    struct Restore {
+        DecodeWorkspace& ws;
+        TelemetryWriter* saved;
+        ~Restore() { ws.telemetry = saved; }
+    } restore{ws, savedTelemetry};
+
+    SampleSource source(reader, plan.params.sampleRate);
+    DataLayout layout;
+    if (source.skip(plan.params.startSample) != plan.params.startSample ||
+        !readStreamHeader(source, plan, ws, layout, status)) {
         return false;
     }
 
-    uint64_t totalSymbols = numSamples / shape.N;
-    if (totalSymbols <= static_cast<uint64_t>(params.syncSymbols)) {
-        std::cerr << "Not enough symbols for sync and data.\n";
+    const DemodPlan& demod = *layout.demod;
+    const uint32_t N = demod.N;
+    const size_t bitsPerSymbol = static_cast<size_t>(demod.subbands) * static_cast<size_t>(demod.toneBits);
+    constexpr size_t PEEK_BYTES = FRAME_HEADER_BYTES + FRAME_EXT_BYTES;
+    const size_t prefixSymbols = (prefixCodedBits(PEEK_BYTES, layout.fec) + bitsPerSymbol - 1) / bitsPerSymbol;
+    const bool tailBiting = layout.fec && layout.tailBiting;
+    const WavInfo& info = reader.info();
+
+    index = FrameIndex{};
+    index.sampleRate    = info.sampleRate;
+    index.symbolSamples = N;
+    index.rateModeId    = layout.modeId;
+
+    uint64_t sampleOffset = plan.params.startSample + streamHeaderSamples(plan);
+    for (;;) {
+        if (info.sizeKnown && sampleOffset + prefixSymbols * N > info.numFrames) {
+            break;
+        }
+        if (!reader.seekFrame(sampleOffset)) {
+            return false;
+        }
+        ws.codedBits.clear();
+        size_t got = 0;
+        while (got < prefixSymbols && readWindow(reader, N, layout.demodQ15 != nullptr, ws)) {
+            demodWindow(demod, layout.demodQ15, ws, ws.codedBits);
+            ++got;
+        }
+
+        // 最后一帧之后的静音 / 录音结尾：marker 不符即结束
+        uint8_t hdr[PEEK_BYTES];
+        if (got < prefixSymbols ||
+            !peekFrameBytes(ws.codedBits.data(), ws.codedBits.size(), layout.fec, tailBiting, ws, PEEK_BYTES, hdr) ||
+            hdr[0] != 0xA5 || hdr[1] != 0x5A) {
+            break;
+        }
+        const uint8_t seq = hdr[4];
+        const size_t payloadLen = static_cast<size_t>(hdr[2]) | (static_cast<size_t>(hdr[3]) << 8);
+        FrameExtHeader ext;
+        if (!(seq & FRAME_FLAG_EXTENDED) || payloadLen < FRAME_EXT_BYTES ||
+            !getFrameExtHeader(hdr + FRAME_HEADER_BYTES, FRAME_EXT_BYTES, ext)) {
+            if (index.frames.empty()) {
+                std::cerr << "Not a multi-frame stream (encode with --frame-size).\n";
+                return false;
+            }
+            break;
+        }
+        const bool consistent = index.frames.empty()
+            ? ext.offset == 0
+            : ext.total == index.totalBytes && ext.offset > index.frames.back().byteOffset;
+        if (!consistent || ext.offset >= ext.total) {
+            std::cerr << "Inconsistent frame header at sample " << sampleOffset
+                      << " (frame " << index.frames.size() << ").\n";
+            return false;
+        }
+
+        FrameIndexEntry e;
+        e.byteOffset   = ext.offset;
+        e.sampleOffset = sampleOffset;
+        e.symbols      = static_cast<uint32_t>(
+            (frameCodedBits(payloadLen, layout.fec, tailBiting) + bitsPerSymbol - 1) / bitsPerSymbol);
+        index.totalBytes = ext.total;
+        index.frames.push_back(e);
+        sampleOffset += static_cast<uint64_t>(e.symbols) * N;
+
+        // 未压缩的帧可以直接判断是否为最后一帧；压缩帧读到下一帧头不符为止
+        if (!(seq & FRAME_FLAG_COMPRESSED) && ext.offset + (payloadLen - FRAME_EXT_BYTES) >= ext.total) {
+            break;
+        }
+    }
+
+    if (index.frames.empty()) {
+        std::cerr << "No frame header found.\n";
         return false;
     }
+    // 各帧的数据长度 = 到下一帧偏移的距离（压缩帧的解压后长度只能这样得到）
+    for (size_t i = 0; i < index.frames.size(); ++i) {
+        const uint64_t next = (i + 1 < index.frames.size()) ? index.frames[i + 1].byteOffset : index.totalBytes;
+        index.frames[i].byteLen = static_cast<uint32_t>(next - index.frames[i].byteOffset);
+    }
+    return true;
+}
 
-    // 3. 预计算 16 个 bin 的 Goertzel 配置
-    std::array<GoertzelConfig, 16> cfgs;
-    try {
-        for (int i = 0; i < 16; ++i) {
-            cfgs[i] = makeGoertzelConfigFromBin(params.bins[i], shape.N);
+// 按索引只解码覆盖 [rangeBegin, rangeEnd) 的帧，写出该区间的字节
+bool decodeRange(
+    const std::string& inputWavPath,
+    const std::string& outputBinPath,
+    WavReader& reader,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws,
+    std::ostream& status
+) {
+    const DecodeParams& params = plan.params;
+    if (!checkSeekable(inputWavPath, reader, params)) {
+        return false;
+    }
+
+    // 索引：显式给出 > "<输入>.idx" > 扫描一遍帧头
+    FrameIndex index;
+    const std::string indexPath = params.indexPath.empty() ? inputWavPath + ".idx" : params.indexPath;
+    if (!params.indexPath.empty() || std::ifstream(indexPath).good()) {
+        if (!readFrameIndex(indexPath, index)) {
+            return false;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error in makeGoertzelConfigFromBin: " << e.what() << "\n";
+    } else {
+        if (params.verbose) {
+            status << "No frame index (" << indexPath << "), scanning frame headers\n";
+        }
+        if (!scanFrameIndex(reader, plan, ws, index, status)) {
+            return false;
+        }
+    }
+
+    if (index.rateModeId >= 0 && !params.adaptive) {
+        std::cerr << "Frame index is for an adaptive stream (rate mode " << index.rateModeId
+                  << "), decode with --adaptive.\n";
+        return false;
+    }
+    if (index.rateModeId >= RATE_MODE_COUNT || (index.rateModeId < 0 && params.adaptive)) {
+        std::cerr << "Frame index rate mode does not match the decode parameters.\n";
+        return false;
+    }
+    const DataLayout layout = dataLayout(plan, index.rateModeId);
+    if (index.sampleRate != reader.info().sampleRate || index.symbolSamples != layout.demod->N) {
+        std::cerr << "Frame index does not match the input (" << index.sampleRate << " Hz, "
+                  << index.symbolSamples << " samples per symbol).\n";
+        return false;
+    }
+
+    const uint64_t begin = params.rangeBegin;
+    const uint64_t end   = std::min(params.rangeEnd, index.totalBytes);
+    if (begin >= end) {
+        std::cerr << "Byte range [" << begin << ", " << params.rangeEnd << ") is empty or outside the "
+                  << index.totalBytes << "-byte stream.\n";
+        return false;
+    }
+    size_t first = 0;
+    size_t last = 0;
+    framesCovering(index, begin, end, first, last);
+
+    AsyncWriter out;
+    if (!out.open(outputBinPath)) {
+        std::cerr << "Failed to open output file: " << outputBinPath << "\n";
+        return false;
+    }
+    for (size_t i = first; i < last; ++i) {
+        const FrameIndexEntry& e = index.frames[i];
+        FrameResult fr;
+        if (!reader.seekFrame(e.sampleOffset) || !decodeFrame(reader, layout, ws, fr)) {
+            std::cerr << "Failed to decode frame " << i << " at sample " << e.sampleOffset << ".\n";
+            return false;
+        }
+        if (!fr.extended || fr.ext.offset != e.byteOffset || fr.size != e.byteLen) {
+            std::cerr << "Frame " << i << " does not match the index (stale index?).\n";
+            return false;
+        }
+        const uint64_t lo = std::max(begin, e.byteOffset) - e.byteOffset;
+        const uint64_t hi = std::min(end, e.byteOffset + e.byteLen) - e.byteOffset;
+        out.write(fr.data + lo, static_cast<size_t>(hi - lo));
+    }
+    if (!out.close()) {
+        std::cerr << "Failed to write output: " << outputBinPath << "\n";
         return false;
     }
 
-    std::vector<int16_t> frame(shape.N);
+    if (params.verbose) {
+        status << "Decoded bytes [" << begin << ", " << end << ") from " << (last - first)
+               << " of " << index.frames.size() << " frames to " << outputBinPath << "\n";
+    }
+    return true;
+}
+
+
+// -------------------- 流水线解码 --------------------
+// I/O（读取 + 重采样）-> 解调 -> FEC -> 帧解析 / CRC / 解压 -> 写出，各级一个线程，
+// 相邻两级之间一条有界 SPSC 队列。每次交接一块样本或一整帧，稳态吞吐由最慢的一级决定
+
+constexpr size_t PIPE_BLOCK_SYMBOLS = 256;  // 样本队列每块的符号数（按前导符号长度计）
+constexpr size_t PIPE_SAMPLE_SLOTS  = 16;   // 样本队列容量（块）
+constexpr size_t PIPE_FRAME_SLOTS   = 4;    // 帧队列容量（帧）
+
+// 定点路径时样本在 pcm 中（WavReader 直接读出的 int16），否则在 samples 中
+struct SampleBlock {
+    std::vector<float>   samples;
+    std::vector<int16_t> pcm;
+    size_t               count = 0;
+    bool                 end   = false;   // 之后没有数据了（本块仍可能有 count 个样本）
+};
 
-    // 4. 16-FSK 解调 -> codedBits（FEC 前的 bit 流）
+struct CodedFrame {
     std::vector<uint8_t> codedBits;
-    codedBits.reserve(static_cast<size_t>((totalSymbols - params.syncSymbols) * 4)); // 1 符号 4bit
+    size_t               frameBits = 0;
+    DataLayout           layout;
+    bool                 end = false;
+};
+
+struct FrameBytes {
+    std::vector<uint8_t> bytes;
+    DataLayout           layout;
+    bool                 end = false;
+};
+
+struct PayloadChunk {
+    std::vector<uint8_t> data;
+    uint8_t              seq      = 0;
+    bool                 extended = false;
+    FrameExtHeader       ext;
+    bool                 end      = false;
+};
+
+// 解调级的样本源：按块从样本队列取数据，接口与 SampleSource 的 read/skip 一致
+class RingSource {
+public:
+    RingSource(SpscRing<SampleBlock>& ring, const std::atomic<bool>& stop, bool lengthKnown, uint64_t total)
+        : ring_(ring), stop_(stop), lengthKnown_(lengthKnown), total_(total) {}
+
+    uint64_t totalSamples() const { return total_; }
+    bool lengthKnown() const { return lengthKnown_; }
+
+    size_t read(float* out, size_t count) { return take(block_.samples, out, count); }
+    size_t read(int16_t* out, size_t count) { return take(block_.pcm, out, count); }
+
+    uint64_t skip(uint64_t count) {
+        uint64_t done = 0;
+        while (done < count && fill()) {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(count - done, block_.count - pos_));
+            pos_ += n;
+            done += n;
+        }
+        return done;
+    }
+
+private:
+    template <typename T>
+    size_t take(const std::vector<T>& from, T* out, size_t count) {
+        size_t got = 0;
+        while (got < count && fill()) {
+            const size_t n = std::min(count - got, block_.count - pos_);
+            std::copy(from.data() + pos_, from.data() + pos_ + n, out + got);
+            pos_ += n;
+            got += n;
+        }
+        return got;
+    }
+
+    bool fill() {
+        while (pos_ >= block_.count) {
+            if (ended_ || !ring_.pop(block_, stop_)) {
+                ended_ = true;
+                return false;
+            }
+            pos_ = 0;
+            ended_ = block_.end;
+        }
+        return true;
+    }
+
+    SpscRing<SampleBlock>&   ring_;
+    const std::atomic<bool>& stop_;
+    bool                     lengthKnown_;
+    uint64_t                 total_;
+    SampleBlock              block_;
+    size_t                   pos_   = 0;
+    bool                     ended_ = false;
+};
+
+// 帧头前缀已能看出这是流中最后一帧时返回 true：单帧传输，或未压缩的多帧流末帧。
+// 解调级据此不再往后读，管道输入不必等 EOF；压缩帧判断不了，读到下一帧头不符为止
+bool isLastFrame(const DataLayout& layout, const std::vector<uint8_t>& codedBits, DecodeWorkspace& ws) {
+    constexpr size_t PEEK_BYTES = FRAME_HEADER_BYTES + FRAME_EXT_BYTES;
+    uint8_t hdr[PEEK_BYTES];
+    if (!peekFrameBytes(codedBits.data(), codedBits.size(), layout.fec, layout.fec && layout.tailBiting,
+                        ws, PEEK_BYTES, hdr)) {
+        return false;
+    }
+    const uint8_t seq = hdr[4];
+    if (!(seq & FRAME_FLAG_EXTENDED)) {
+        return true;
+    }
+    const size_t payloadLen = static_cast<size_t>(hdr[2]) | (static_cast<size_t>(hdr[3]) << 8);
+    FrameExtHeader ext;
+    if ((seq & FRAME_FLAG_COMPRESSED) || payloadLen < FRAME_EXT_BYTES ||
+        !getFrameExtHeader(hdr + FRAME_HEADER_BYTES, FRAME_EXT_BYTES, ext)) {
+        return false;
+    }
+    return static_cast<uint64_t>(ext.offset) + (payloadLen - FRAME_EXT_BYTES) >= ext.total;
+}
+
+// I/O 级：读取（经 AsyncReader 预读）+ 重采样，按块送入样本队列
+// 已到达的样本立即送出（管道上不等凑满一块），读到 0 个样本才是 EOF
+// 定点路径读 int16 样本（见 SampleBlock）
+void ioStage(SampleSource& source, size_t blockSamples, bool fixedPoint, SpscRing<SampleBlock>& out,
+             const std::atomic<bool>& stop) {
+    SampleBlock block;
+    for (;;) {
+        if (fixedPoint) {
+            block.pcm.resize(blockSamples);
+            block.count = source.readSome(block.pcm.data(), blockSamples);
+        } else {
+            block.samples.resize(blockSamples);
+            block.count = source.readSome(block.samples.data(), blockSamples);
+        }
+        block.end = block.count == 0;
+        const bool end = block.end;
+        if (!out.push(block, stop) || end) {
+            return;
+        }
+    }
+}
+
+// 解调级：前导 / 模式头，然后逐帧解调。帧头不符（最后一帧之后的静音或其它信号）或 EOF 时结束
+bool demodStage(RingSource& source, const DecoderPlan& plan, DecodeWorkspace& ws,
+                SpscRing<CodedFrame>& out, const std::atomic<bool>& stop, std::ostream& status) {
+    DataLayout layout;
+    if (!readStreamHeader(source, plan, ws, layout, status)) {
+        return false;
+    }
 
-    for (uint64_t symIdx = 0; symIdx < totalSymbols; ++symIdx) {
-        if (!ifs.read(reinterpret_cast<char*>(frame.data()),
-                      static_cast<std::streamsize>(frame.size() * sizeof(int16_t)))) {
-            std::cerr << "Unexpected end of WAV data.\n";
+    CodedFrame item;
+    for (bool first = true; ; first = false) {
+        size_t frameBits = 0;
+        const bool got = demodFrame(source, layout, ws, item.codedBits, frameBits, true);
+        if (!got || frameBits == 0) {
+            if (first) {
+                std::cerr << (got ? "Frame marker mismatch.\n" : "No coded bits decoded from FSK.\n");
+                return false;
+            }
             break;
         }
+        const bool last = isLastFrame(layout, item.codedBits, ws);
+        item.frameBits = frameBits;
+        item.layout    = layout;
+        item.end       = false;
+        if (!out.push(item, stop)) {
+            return true;
+        }
+        if (last) {
+            break;
+        }
+    }
+    item.end = true;
+    out.push(item, stop);
+    return true;
+}
 
-        // 前 syncSymbols 个符号作为同步，扔掉
-        if (symIdx < static_cast<uint64_t>(params.syncSymbols)) {
-            continue;
+// FEC 级：Viterbi + bit 打包
+bool fecStage(SpscRing<CodedFrame>& in, SpscRing<FrameBytes>& out, const std::atomic<bool>& stop) {
+    DecodeWorkspace ws;
+    CodedFrame item;
+    FrameBytes frame;
+    while (in.pop(item, stop)) {
+        frame.end = item.end;
+        if (!item.end) {
+            FrameTelemetry ftlm;
+            if (!fecDecodeFrame(item.layout, item.codedBits, item.frameBits, ws, frame.bytes, ftlm)) {
+                return false;
+            }
+            frame.layout = item.layout;
         }
+        const bool end = frame.end;
+        if (!out.push(frame, stop) || end) {
+            break;
+        }
+    }
+    return true;
+}
 
-        // DC 去除 + Hann 窗
-        preprocessFrame(frame);
+// 帧级：marker / CRC、扩展头、解压
+bool frameStage(SpscRing<FrameBytes>& in, SpscRing<PayloadChunk>& out, const std::atomic<bool>& stop) {
+    DecodeWorkspace ws;
+    const std::vector<uint8_t> noCodedBits;
+    FrameBytes frame;
+    PayloadChunk chunk;
+    while (in.pop(frame, stop)) {
+        chunk.end = frame.end;
+        if (!frame.end) {
+            FrameResult fr;
+            if (!unpackFrame(frame.layout, frame.bytes, noCodedBits, ws, fr, nullptr)) {
+                return false;
+            }
+            chunk.data.assign(fr.data, fr.data + fr.size);
+            chunk.seq      = fr.seq;
+            chunk.extended = fr.extended;
+            chunk.ext      = fr.ext;
+        }
+        const bool end = chunk.end;
+        if (!out.push(chunk, stop) || end) {
+            break;
+        }
+    }
+    return true;
+}
 
-        int symbolIndex = detectSymbolIndex(frame.data(), cfgs); // 0..15
+void printRingStats(std::ostream& status, const char* name, const RingStats& s) {
+    const double avgDepth = s.pushes ? static_cast<double>(s.depthSum) / static_cast<double>(s.pushes) : 0.0;
+    status << "  " << name << ": " << s.pushes << " items, depth avg " << avgDepth << " max " << s.maxDepth
+           << ", full stalls " << s.fullStalls << ", empty stalls " << s.emptyStalls << "\n";
+}
 
-        // 还原 4 bit（顺序与编码端完全一致：b3,b2,b1,b0）
-        for (int bitPos = 3; bitPos >= 0; --bitPos) {
-            int bit = (symbolIndex >> bitPos) & 0x1;
-            codedBits.push_back(static_cast<uint8_t>(bit));
+// 写出级在调用线程上运行：单帧直接写出；多帧流按扩展头中的偏移校验后边解边写，不必整体缓存
+bool decodePipelined(
+    SampleSource& source,
+    const std::string& outputBinPath,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws,
+    std::ostream& status
+) {
+    const DecodeParams& params = plan.params;
+    AsyncWriter out;
+    if (!out.open(outputBinPath)) {
+        std::cerr << "Failed to open output file: " << outputBinPath << "\n";
+        return false;
+    }
+
+    SpscRing<SampleBlock>  samples(PIPE_SAMPLE_SLOTS);
+    SpscRing<CodedFrame>   coded(PIPE_FRAME_SLOTS);
+    SpscRing<FrameBytes>   frames(PIPE_FRAME_SLOTS);
+    SpscRing<PayloadChunk> payloads(PIPE_FRAME_SLOTS);
+    std::atomic<bool> stop{false};
+
+    // 任何一级失败（已打印原因）都置 stop，其余各级在等待中退出
+    bool demodOk = true;
+    bool fecOk = true;
+    bool frameOk = true;
+    RingSource ringSource(samples, stop, source.lengthKnown(), source.totalSamples());
+    std::thread ioThread([&] {
+        ioStage(source, PIPE_BLOCK_SYMBOLS * plan.demod.N, plan.params.fixedPoint, samples, stop);
+    });
+    std::thread demodThread([&] {
+        demodOk = demodStage(ringSource, plan, ws, coded, stop, status);
+        if (!demodOk) stop = true;
+    });
+    std::thread fecThread([&] {
+        fecOk = fecStage(coded, frames, stop);
+        if (!fecOk) stop = true;
+    });
+    std::thread frameThread([&] {
+        frameOk = frameStage(frames, payloads, stop);
+        if (!frameOk) stop = true;
+    });
+
+    bool ok = false;
+    bool multi = false;
+    uint64_t written = 0;
+    uint64_t total = 0;
+    size_t numFrames = 0;
+    PayloadChunk chunk;
+    while (payloads.pop(chunk, stop)) {
+        if (chunk.end) {
+            if (multi) {
+                std::cerr << "Stream ended after " << written << " of " << total << " bytes.\n";
+            }
+            break;
+        }
+        if (numFrames == 0) {
+            multi = chunk.extended;
+            total = chunk.ext.total;
+        }
+        if (multi && (!chunk.extended || chunk.ext.total != total || chunk.ext.offset != written ||
+                      chunk.data.size() > total - written)) {
+            std::cerr << "Frame out of sequence at byte " << written
+                      << " (frame offset " << chunk.ext.offset << ").\n";
+            break;
+        }
+        out.write(chunk.data.data(), chunk.data.size());
+        written += chunk.data.size();
+        ++numFrames;
+        if (!multi || written == total) {
+            ok = true;
+            break;
         }
     }
 
-    if (codedBits.empty()) {
-        std::cerr << "No coded bits decoded from FSK.\n";
+    // 写完（或出错）后让上游不再继续解调后面的信号
+    // I/O 级可能正阻塞在 stdin 的读上（上游还没写完也没关）：取消它，而不是等上游
+    stop = true;
+    source.cancel();
+    ioThread.join();
+    demodThread.join();
+    fecThread.join();
+    frameThread.join();
+
+    if (!out.close()) {
+        std::cerr << "Failed to write output: " << outputBinPath << "\n";
+        return false;
+    }
+    if (!ok) {
         return false;
     }
 
-    // 5. 卷积 Viterbi 解码 -> 原始帧 bit 流
-    std::vector<uint8_t> bits;
-    if (!convDecode(codedBits, bits)) {
-        std::cerr << "Convolutional decode failed.\n";
+    PipelineStats stats;
+    stats.samples  = samples.stats();
+    stats.coded    = coded.stats();
+    stats.frames   = frames.stats();
+    stats.payloads = payloads.stats();
+    if (ws.pipelineStats) {
+        *ws.pipelineStats = stats;
+    }
+    if (params.verbose) {
+        status << "Decoded " << written << " payload bytes in " << numFrames
+               << (numFrames == 1 ? " frame" : " frames") << " (pipelined) to " << outputBinPath << "\n"
+               << "Pipeline queues:\n";
+        printRingStats(status, "samples -> demod ", stats.samples);
+        printRingStats(status, "demod   -> fec   ", stats.coded);
+        printRingStats(status, "fec     -> frame ", stats.frames);
+        printRingStats(status, "frame   -> sink  ", stats.payloads);
+    }
+    return true;
+}
+
+
+// -------------------- 多发送端单遍解码 --------------------
+// 每路一个状态机：前导中 -> 数据段（逐符号累积编码比特，读到帧头后按帧长收齐一帧）-> 完成 / 失败。
+// 只有处于数据段的流参与共享频谱；活动集合变化时重新取 bin 并集
+
+enum class ChannelPhase { Preamble, Data, Done, Failed };
+
+struct ChannelState {
+    DecoderPlan     plan;
+    DataLayout      layout;
+    DecodeWorkspace ws;
+    ChannelPhase    phase         = ChannelPhase::Preamble;
+    bool            prefixChecked = false;
+    size_t          frameBits     = 0;
+    size_t          neededBits    = SIZE_MAX;
+    size_t          frames        = 0;   // 已解出的帧数
+    uint64_t        total         = 0;   // 多帧流总长（第一帧的扩展头）
+};
+
+// 把解出的完整 payload 写到输出文件（按块异步提交）
+bool writePayloadFile(const std::string& path, const uint8_t* data, size_t size) {
+    AsyncWriter out;
+    if (!out.open(path)) {
+        std::cerr << "Failed to open output file: " << path << "\n";
+        return false;
+    }
+    out.write(data, size);
+    if (!out.close()) {
+        std::cerr << "Failed to write output: " << path << "\n";
         return false;
     }
+    return true;
+}
+
+// 一路收齐一帧（或输入结束）后：FEC、帧解析，单帧或多帧流的最后一帧解出后写出
+void finishChannelFrame(ChannelState& c, const std::string& outputPath, ChannelResult& result) {
+    FrameResult fr;
+    if (!finishFrame(c.layout, c.ws, c.frameBits, fr)) {
+        c.phase = ChannelPhase::Failed;
+        return;
+    }
+    const uint8_t* data = fr.data;
+    size_t size = fr.size;
+    if (c.frames == 0 && fr.extended) {
+        c.total = fr.ext.total;
+        c.ws.stream.clear();
+    }
+    if (c.frames > 0 && !fr.extended) {
+        std::cerr << "Stream ended after " << c.ws.stream.size() << " of " << c.total << " bytes.\n";
+        c.phase = ChannelPhase::Failed;
+        return;
+    }
+    ++c.frames;
+    if (fr.extended) {
+        if (!appendStreamFrame(fr, c.total, c.ws.stream)) {
+            c.phase = ChannelPhase::Failed;
+            return;
+        }
+        if (c.ws.stream.size() < c.total) {
+            // 下一帧紧接着开始
+            c.ws.codedBits.clear();
+            c.prefixChecked = false;
+            c.frameBits = 0;
+            c.neededBits = SIZE_MAX;
+            return;
+        }
+        data = c.ws.stream.data();
+        size = c.ws.stream.size();
+    }
+    if (!writePayloadFile(outputPath, data, size)) {
+        c.phase = ChannelPhase::Failed;
+        return;
+    }
+    result.ok = true;
+    result.bytes = size;
+    c.phase = ChannelPhase::Done;
+}
 
-    // 6. bit 流 -> frameBytes
-    std::vector<uint8_t> frameBytes;
-    bitsToBytes(bits, frameBytes);
+// 一个数据符号的判决追加到该路的编码比特；读到帧头时确定帧长，收齐后解出该帧
+void pushChannelSymbol(ChannelState& c, const int* symbols, const std::string& outputPath,
+                       ChannelResult& result) {
+    const DemodPlan& demod = *c.layout.demod;
+    const bool useFec = c.layout.fec;
+    const bool tailBiting = useFec && c.layout.tailBiting;
+    std::vector<uint8_t>& coded = c.ws.codedBits;
+    appendSymbolBits(symbols, demod.subbands, demod.toneBits, coded);
+    ++result.dataSymbols;
 
-    // 7. 帧解析（marker/length/CRC）
-    std::vector<uint8_t> payload;
-    uint8_t seq = 0;
-    if (!parseFrame(frameBytes, payload, seq)) {
-        std::cerr << "Frame parse failed (marker or CRC error).\n";
+    if (!c.prefixChecked && coded.size() >= framePrefixCodedBits(useFec)) {
+        c.prefixChecked = true;
+        size_t payloadLen = 0;
+        if (!peekFrameHeader(coded.data(), coded.size(), useFec, tailBiting, c.ws, payloadLen)) {
+            // 与单路解码不同，不读到 EOF 再失败：这一路不再占用频谱扫描
+            std::cerr << "Frame header marker mismatch.\n";
+            c.phase = ChannelPhase::Failed;
+            return;
+        }
+        const size_t bitsPerSymbol = static_cast<size_t>(demod.subbands) * demod.toneBits;
+        c.frameBits = frameCodedBits(payloadLen, useFec, tailBiting);
+        c.neededBits = (c.frameBits + bitsPerSymbol - 1) / bitsPerSymbol * bitsPerSymbol;
+        coded.reserve(c.neededBits);
+    }
+    if (coded.size() >= c.neededBits) {
+        finishChannelFrame(c, outputPath, result);
+    }
+}
+
+} // namespace
+
+bool decodeWavToFile(
+    const std::string& inputWavPath,
+    const std::string& outputBinPath,
+    const DecoderPlan& plan
+) {
+    DecodeWorkspace ws;
+    return decodeWavToFile(inputWavPath, outputBinPath, plan, ws);
+}
+
+bool decodeWavToFile(
+    const std::string& inputWavPath,
+    const std::string& outputBinPath,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws
+) {
+    const DecodeParams& params = plan.params;
+    const bool toStdout = (outputBinPath == "-");
+    std::ostream& status = toStdout ? std::cerr : std::cout;
+
+    // 1. 读 WAV 头：逐 chunk 定位到 data，样本统一转换为 float（裸 PCM 无头）
+    WavReader reader;
+    if (!(params.rawPcm ? reader.openRawPcm16(inputWavPath, params.sampleRate)
+                        : reader.open(inputWavPath))) {
         return false;
     }
+    const WavInfo& info = reader.info();
 
-    // 8. 写回原始 payload
-    std::ofstream ofs_out(outputBinPath, std::ios::binary);
-    if (!ofs_out) {
-        std::cerr << "Failed to open output file: " << outputBinPath << "\n";
+    if (params.pipeline && (params.range || ws.telemetry || !params.telemetryPath.empty())) {
+        std::cerr << "Pipelined decode does not support --range / --telemetry.\n";
+        return false;
+    }
+
+    // 遥测：调用方没有提供时按参数为这次解码打开一份，返回前关闭（写线程在此之前写完）
+    TelemetryWriter localTelemetry;
+    TelemetryWriter* const savedTelemetry = ws.telemetry;
+    if (!params.telemetryPath.empty() && !ws.telemetry) {
+        if (!localTelemetry.open(params.telemetryPath, telemetryFormatForPath(params.telemetryPath))) {
+            return false;
+        }
+        ws.telemetry = &localTelemetry;
+    }
+
+    // 只取多帧流的一段：按索引 seek 到覆盖的帧
+    if (params.range) {
+        const bool decoded = decodeRange(inputWavPath, outputBinPath, reader, plan, ws, status);
+        ws.telemetry = savedTelemetry;
+        const bool telemetryOk = localTelemetry.close();
+        return decoded && telemetryOk;
+    }
+
+    // 采样率不一致时在解调前插入多相重采样，单次遍历完成
+    std::unique_ptr<SampleSource> source;
+    try {
+        source.reset(new SampleSource(reader, params.sampleRate));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        ws.telemetry = savedTelemetry;
+        return false;
+    }
+    if (source->resampling() && params.verbose) {
+        status << "Resampling " << info.sampleRate << " Hz -> "
+               << params.sampleRate << " Hz\n";
+    }
+    if (source->skip(params.startSample) != params.startSample) {
+        std::cerr << "Start sample " << params.startSample << " is beyond the end of the input.\n";
+        ws.telemetry = savedTelemetry;
+        return false;
+    }
+
+    if (params.pipeline) {
+        return decodePipelined(*source, outputBinPath, plan, ws, status);
+    }
+
+    // 2..8. 解调、FEC、逐帧解析、解压
+    PayloadView payload;
+    const bool decoded = decodeFromSource(*source, plan, ws, payload, status);
+    ws.telemetry = savedTelemetry;
+    const bool telemetryOk = localTelemetry.close();
+    if (!decoded || !telemetryOk) {
+        return false;
+    }
+
+    // 9. 写回原始 payload（按块提交，大 payload 的各块同时在途）
+    if (!writePayloadFile(outputBinPath, payload.data, payload.size)) {
         return false;
     }
-    ofs_out.write(reinterpret_cast<const char*>(payload.data()),
-                  static_cast<std::streamsize>(payload.size()));
 
-    std::cout << "Decoded " << payload.size()
-              << " payload bytes (Frame+FEC+16-FSK DFT-bin) to "
-              << outputBinPath << "\n";
+    if (params.verbose) {
+        status << "Decoded " << payload.size
+                  << " payload bytes (Frame+FEC+16-FSK DFT-bin) to "
+                  << outputBinPath << "\n";
+    }
     return true;
-}
\ No newline at end of file
+}
+
+bool buildFrameIndex(
+    const std::string& inputWavPath,
+    const DecoderPlan& plan,
+    FrameIndex& index
+) {
+    const DecodeParams& params = plan.params;
+    WavReader reader;
+    if (!(params.rawPcm ? reader.openRawPcm16(inputWavPath, params.sampleRate)
+                        : reader.open(inputWavPath))) {
+        return false;
+    }
+    if (!checkSeekable(inputWavPath, reader, params)) {
+        return false;
+    }
+    DecodeWorkspace ws;
+    return scanFrameIndex(reader, plan, ws, index, std::cout);
+}
+
+bool decodeSamples(
+    const float* samples,
+    size_t count,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws,
+    PayloadView& payload
+) {
+    MemorySource source(samples, count);
+    return decodeFromSource(source, plan, ws, payload, std::cout);
+}
+
+bool probeFirstFrame(
+    const float* samples,
+    size_t count,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws,
+    size_t& payloadLen,
+    bool& crcChecked
+) {
+    crcChecked = false;
+    MemorySource source(samples, count);
+    DataLayout layout;
+    if (!readStreamHeader(source, plan, ws, layout, std::cout)) {
+        return false;
+    }
+
+    const size_t bitsPerSymbol = static_cast<size_t>(layout.demod->subbands) *
+                                 static_cast<size_t>(layout.demod->toneBits);
+    size_t frameBits = 0;
+    demodFrame(source, layout, ws, ws.codedBits, frameBits, true);
+    if (frameBits == 0) {
+        return false;
+    }
+    peekFrameHeader(ws.codedBits.data(), ws.codedBits.size(), layout.fec,
+                    layout.fec && layout.tailBiting, ws, payloadLen);
+    if (ws.codedBits.size() < (frameBits + bitsPerSymbol - 1) / bitsPerSymbol * bitsPerSymbol) {
+        return true;   // 整帧不在 samples 内，只验证了帧头
+    }
+
+    FrameTelemetry ftlm;
+    if (!fecDecodeFrame(layout, ws.codedBits, frameBits, ws, ws.frameBytes, ftlm)) {
+        return false;
+    }
+    const size_t frameLen = FRAME_HEADER_BYTES + payloadLen + FRAME_CRC_BYTES;
+    if (ws.frameBytes.size() < frameLen) {
+        return false;
+    }
+    const uint8_t* f = ws.frameBytes.data();
+    const uint16_t crcRecv = static_cast<uint16_t>((f[frameLen - 2] << 8) | f[frameLen - 1]);
+    crcChecked = true;
+    return crcRecv == crc16_ccitt(f, frameLen - FRAME_CRC_BYTES);
+}
+
+void demodulateSymbols(
+    const float* samples,
+    uint64_t numSymbols,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws,
+    std::vector<uint8_t>& bitsOut
+) {
+    const DemodPlan& demod = plan.demod;
+    const DemodPlanQ15* demodQ15 = plan.params.fixedPoint ? &plan.demodQ15 : nullptr;
+    MemorySource source(samples, static_cast<size_t>(numSymbols * demod.N));
+    for (uint64_t k = 0; k < numSymbols && readWindow(source, demod.N, demodQ15 != nullptr, ws); ++k) {
+        demodWindow(demod, demodQ15, ws, bitsOut);
+    }
+}
+
+bool decodeChannelsToFiles(
+    const std::string& inputWavPath,
+    const DecodeParams& shared,
+    const std::vector<ChannelStream>& streams,
+    std::vector<ChannelResult>& results,
+    ChannelStats& stats
+) {
+    results.assign(streams.size(), ChannelResult{});
+    stats = ChannelStats{};
+    if (streams.empty()) {
+        std::cerr << "No streams to decode.\n";
+        return false;
+    }
+    if (shared.adaptive || shared.fixedPoint || shared.range || shared.pipeline ||
+        !shared.telemetryPath.empty()) {
+        std::cerr << "Multi-stream decode does not support --adaptive / --fixed-point / --range / "
+                     "--pipeline / --telemetry.\n";
+        return false;
+    }
+
+    // 每路的计划：bin 组与 FEC 变体各自的，采样率 / 符号时长 / 起点统一取共享参数
+    std::vector<ChannelState> channels(streams.size());
+    std::vector<const DemodPlan*> demods;
+    for (size_t i = 0; i < streams.size(); ++i) {
+        DecodeParams p = streams[i].params;
+        p.sampleRate = shared.sampleRate;
+        p.symbolDurationSec = shared.symbolDurationSec;
+        p.startSample = shared.startSample;
+        p.rawPcm = shared.rawPcm;
+        p.adaptive = false;
+        p.fixedPoint = false;
+        p.verbose = false;
+        if (!buildDecoderPlan(p, channels[i].plan)) {
+            std::cerr << "Stream " << i << " (" << streams[i].outputPath << "): invalid parameters.\n";
+            return false;
+        }
+        channels[i].layout = dataLayout(channels[i].plan, -1);
+        demods.push_back(&channels[i].plan.demod);
+    }
+    std::unique_ptr<ChannelBank> bank;
+    try {
+        bank.reset(new ChannelBank(demods));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return false;
+    }
+
+    WavReader reader;
+    if (!(shared.rawPcm ? reader.openRawPcm16(inputWavPath, shared.sampleRate)
+                        : reader.open(inputWavPath))) {
+        return false;
+    }
+    std::unique_ptr<SampleSource> source;
+    try {
+        source.reset(new SampleSource(reader, shared.sampleRate));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return false;
+    }
+    if (source->skip(shared.startSample) != shared.startSample) {
+        std::cerr << "Start sample " << shared.startSample << " is beyond the end of the input.\n";
+        return false;
+    }
+
+    // 所有流共用同一个 N 与 Hann 窗，预处理只做一次
+    const DemodPlan& window = *demods[0];
+    const uint32_t N = window.N;
+    std::vector<float> frame(N);
+    std::vector<bool> active(channels.size(), false);
+    std::vector<int> symbols;
+    size_t pending = channels.size();
+
+    for (uint64_t w = 0; pending > 0 && source->read(frame.data(), N) == N; ++w) {
+        ++stats.windows;
+
+        // 前导刚结束的流从这个窗口起进入数据段
+        bool changed = false;
+        for (size_t i = 0; i < channels.size(); ++i) {
+            ChannelState& c = channels[i];
+            if (c.phase == ChannelPhase::Preamble &&
+                w >= static_cast<uint64_t>(c.plan.params.syncSymbols)) {
+                c.phase = ChannelPhase::Data;
+                active[i] = true;
+                changed = true;
+            }
+        }
+        if (changed) {
+            bank->setActive(active);
+        }
+        if (bank->unionBins() == 0) {
+            continue;
+        }
+
+        preprocessFrame(frame.data(), window);
+        bank->compute(frame.data());
+        ++stats.spectra;
+        if (bank->usingFft()) {
+            ++stats.fftSpectra;
+        } else {
+            stats.binsComputed += bank->unionBins();
+        }
+
+        changed = false;
+        for (size_t i = 0; i < channels.size(); ++i) {
+            ChannelState& c = channels[i];
+            if (!active[i]) continue;
+            symbols.resize(static_cast<size_t>(c.plan.demod.subbands));
+            bank->detect(i, symbols.data());
+            stats.binsUsed += c.plan.demod.bins.size();
+            pushChannelSymbol(c, symbols.data(), streams[i].outputPath, results[i]);
+            if (c.phase != ChannelPhase::Data) {
+                if (c.phase == ChannelPhase::Failed) {
+                    std::cerr << "Stream " << i << " (" << streams[i].outputPath << ") failed at data symbol "
+                              << results[i].dataSymbols << ".\n";
+                }
+                active[i] = false;
+                changed = true;
+                --pending;
+            }
+        }
+        if (changed) {
+            bank->setActive(active);
+        }
+    }
+
+    // 输入结束时还没收齐的帧照常解一次（与单路解码读到 EOF 的行为一致，多半是 CRC 失败）
+    for (size_t i = 0; i < channels.size(); ++i) {
+        ChannelState& c = channels[i];
+        if (c.phase == ChannelPhase::Data && !c.ws.codedBits.empty()) {
+            finishChannelFrame(c, streams[i].outputPath, results[i]);
+        }
+        if (c.phase == ChannelPhase::Failed && !active[i]) {
+            continue;   // 之前已报告
+        }
+        if (c.phase != ChannelPhase::Done) {
+            std::cerr << "Stream " << i << " (" << streams[i].outputPath << ") failed: input ended after "
+                      << results[i].dataSymbols << " data symbols.\n";
+        }
+    }
+    return true;
+}
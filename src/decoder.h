@@ -1,8 +1,16 @@
 // src/decoder.h
 #pragma once
+#include "demod.h"
+#include "demod_q15.h"
+#include "spsc_ring.h"
+
 #include <string>
 #include <cstdint>
 #include <array>
+#include <vector>
+
+class TelemetryWriter;
+struct FrameIndex;
 
 // 16-FSK 解码参数（bin 配置需与编码端保持一致）
 struct DecodeParams {
@@ -16,10 +24,210 @@ struct DecodeParams {
         11, 12, 13, 14,
         15, 16, 17, 18
     };
+
+    int      subbands          = 1;    // 并行子带数 K（与编码端一致）
+    int      subbandStride     = 0;    // 子带间隔（bin 数），0 = 自动取 bins 跨度
+    int      toneBits          = 4;    // 字母表：每子带每符号 bit 数（4/2/1）
+    bool     fec               = true; // 卷积码 FEC（rate 1/2）
+    bool     tailBiting        = false; // 咬尾卷积码（与编码端一致），绕回 Viterbi 解码
+
+    // 自适应速率：前导之后读取模式头，按其中的模式重新配置数据段解调/FEC（见 rate_mode.h）
+    bool     adaptive          = false;
+
+    // 定点解调：样本转 int16 后走 Q15 Goertzel（见 demod_q15.h），结果应与浮点路径一致
+    bool     fixedPoint        = false;
+
+    // 输入为无文件头的裸 PCM（16-bit 小端单声道，采样率取 sampleRate），长度未知时读到 EOF
+    bool     rawPcm            = false;
+
+    // 非空时把每符号判决余量 / 噪声底、帧的 Viterbi 路径度量和混淆矩阵写到该文件
+    // （.csv 为 CSV，其余为紧凑二进制，见 telemetry.h）
+    std::string telemetryPath;
+
+    // 只解出多帧流 payload 的 [rangeBegin, rangeEnd) 字节：按帧索引直接定位到覆盖该区间的帧，
+    // 只解调这些帧（见 frame_index.h）。输入需可 seek，且不做重采样
+    // indexPath 为空时先找 "<输入>.idx"，没有再扫描一遍帧头建立
+    bool        range      = false;
+    uint64_t    rangeBegin = 0;
+    uint64_t    rangeEnd   = UINT64_MAX;
+    std::string indexPath;
+
+    // 流水线解码：I/O、解调、FEC、帧解析各一个线程，之间用有界 SPSC 队列连接（见 spsc_ring.h），
+    // 多帧流边解边写。不支持 telemetryPath / range
+    bool     pipeline          = false;
+
+    // 前导起点（输入中的样本序号，按 sampleRate 计）：之前的样本（录音开头的静音等）直接跳过。
+    // 帧索引中的偏移是绝对样本序号，已包含这一段
+    uint64_t startSample       = 0;
+
+    bool     verbose           = true; // 打印每个文件的进度信息（批处理时关闭）
+};
+
+// 预计算的解码计划（Goertzel 系数、Hann 窗等），参数相同的多个文件可共享，构造后只读
+// 自适应模式下预先为模式头和每个速率模式各建一份解调计划，读到模式头后直接切换
+struct DecoderPlan {
+    DecodeParams           params;
+    DemodPlan              demod;        // 前导/数据段（非自适应模式）
+    DemodPlan              header;       // 模式头（仅自适应模式）
+    std::vector<DemodPlan> modes;        // 各速率模式（仅自适应模式），下标为 mode id
+
+    // 定点路径的对应计划（仅 fixedPoint），由上面的浮点计划换算
+    DemodPlanQ15              demodQ15;
+    DemodPlanQ15              headerQ15;
+    std::vector<DemodPlanQ15> modesQ15;
+};
+
+// 流水线各级之间队列的深度 / 等待统计。fullStalls 多说明下游慢，emptyStalls 多说明上游慢
+struct PipelineStats {
+    RingStats samples;    // I/O   -> 解调
+    RingStats coded;      // 解调  -> FEC
+    RingStats frames;     // FEC   -> 帧解析
+    RingStats payloads;   // 帧解析 -> 写出
+};
+
+// 解码工作区：解调窗口、bit 流、Viterbi 幸存路径、帧字节、解压缓冲
+// 各缓冲只在容量不足时增长，用同一工作区重复解码时稳态下不再分配堆内存；每个线程各用一份
+struct DecodeWorkspace {
+    DemodScratch         scratch;
+    DemodScratchQ15      scratchQ15;
+    std::vector<float>   frame;
+    std::vector<int16_t> frameQ15;
+    std::vector<int>     symbols;
+    std::vector<uint8_t> codedBits;
+    std::vector<uint8_t> survivors;
+    std::vector<uint8_t> bits;
+    std::vector<uint8_t> frameBytes;
+    std::vector<uint8_t> unpacked;
+    std::vector<uint8_t> stream;      // 多帧流按偏移拼接后的 payload
+
+    // 可选的遥测输出（非空时记录每个数据符号的判决余量，由调用方管理生命周期）
+    TelemetryWriter*     telemetry = nullptr;
+
+    // 可选：流水线解码成功后写入各级队列的统计
+    PipelineStats*       pipelineStats = nullptr;
+};
+
+// 解码结果：指向工作区内部的 payload（已解压），在同一工作区下一次解码前有效
+struct PayloadView {
+    const uint8_t* data = nullptr;
+    size_t         size = 0;
+    uint8_t        seq  = 0;      // 帧头 seq 字节（含标志位）
 };
 
+// 参数非法时打印原因并返回 false
+bool buildDecoderPlan(const DecodeParams& params, DecoderPlan& plan);
+
+// inputWavPath / outputBinPath 为 "-" 时使用 stdin / stdout（此时进度信息改写到 stderr）；
+// 输入只顺序读取，可以是管道
 bool decodeWavToFile(
     const std::string& inputWavPath,
     const std::string& outputBinPath,
     const DecodeParams& params = {}
-);
\ No newline at end of file
+);
+
+bool decodeWavToFile(
+    const std::string& inputWavPath,
+    const std::string& outputBinPath,
+    const DecoderPlan& plan
+);
+
+bool decodeWavToFile(
+    const std::string& inputWavPath,
+    const std::string& outputBinPath,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws
+);
+
+// 多发送端单遍解码中的一路：各自的 bins / subbands / subbandStride / syncSymbols / tailBiting
+// 和输出文件；其余参数（采样率、符号时长、起点、裸 PCM）取共享参数
+struct ChannelStream {
+    DecodeParams params;
+    std::string  outputPath;
+};
+
+struct ChannelResult {
+    bool     ok          = false;
+    size_t   bytes       = 0;   // 写出的 payload 字节数
+    uint64_t dataSymbols = 0;   // 本路解调的数据符号数（不含前导）
+};
+
+// 共享频谱的统计
+struct ChannelStats {
+    uint64_t windows      = 0;   // 读入的符号窗口数
+    uint64_t spectra      = 0;   // 做了频谱扫描的窗口数（没有流处于数据段时跳过）
+    uint64_t fftSpectra   = 0;   // 其中用整窗 FFT 的窗口数
+    uint64_t binsComputed = 0;   // Goertzel 路径累计计算的 bin 数（并集去重后）
+    uint64_t binsUsed     = 0;   // 各路判决累计用到的 bin 数（逐路单独解调时要算的量）
+};
+
+// 多发送端单遍解码：同一段录音里多路流共用一个信道，各占一组 bin。
+// 输入只读一遍（重采样、去 DC、Hann 窗各做一次），每个窗口的频谱对所有处于数据段的流只算一次
+// （见 channelizer.h），各路从中取自己的 bin 判决，解出完整的一路就写到它自己的输出文件。
+// 所有流须在同一个符号网格上：采样率、符号时长与起点相同，前导长度可以不同。
+// 不支持 adaptive / fixedPoint / telemetry / range / pipeline。
+// 参数非法或输入无法读取时打印原因并返回 false；各路的成败在 results 中（失败原因已打印）
+bool decodeChannelsToFiles(
+    const std::string& inputWavPath,
+    const DecodeParams& shared,
+    const std::vector<ChannelStream>& streams,
+    std::vector<ChannelResult>& results,
+    ChannelStats& stats
+);
+
+// 扫描多帧流的帧头建立索引：每帧只解调开头几个符号读出帧头（长度 + 扩展头），
+// 然后直接 seek 到下一帧。输入需可 seek，采样率需与 plan.params.sampleRate 一致；
+// 失败时打印原因并返回 false
+bool buildFrameIndex(
+    const std::string& inputWavPath,
+    const DecoderPlan& plan,
+    FrameIndex& index
+);
+
+// 内存解码：samples 为 plan.params.sampleRate 下的单声道样本（±32768 满幅），
+// 从前导开始到数据结束。不做文件 I/O，稳态下不分配内存
+bool decodeSamples(
+    const float* samples,
+    size_t count,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws,
+    PayloadView& payload
+);
+
+// 参数验证：samples 从前导开始（plan.params.sampleRate 下），跳过前导、自适应时读模式头后解出
+// 第一帧帧头（marker + 长度）；整帧都在 samples 内时再做 Viterbi 与 CRC 校验，crcChecked 置 true。
+// marker 不符或 CRC 失败时返回 false。不打印失败原因，用于在多组候选参数之间挑选
+bool probeFirstFrame(
+    const float* samples,
+    size_t count,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws,
+    size_t& payloadLen,
+    bool& crcChecked
+);
+
+// 解调 numSymbols 个连续的数据符号（按 plan.demod，不处理前导与模式头），
+// 每符号 K * toneBits 个 bit 追加到 bitsOut；samples 不会被修改
+void demodulateSymbols(
+    const float* samples,
+    uint64_t numSymbols,
+    const DecoderPlan& plan,
+    DecodeWorkspace& ws,
+    std::vector<uint8_t>& bitsOut
+);
+
+// 一帧（payloadLen 字节 payload）的编码比特数，含 FEC 尾比特（咬尾时没有），未按符号补齐
+size_t frameCodedBits(size_t payloadLen, bool fec, bool tailBiting = false);
+
+// 解出 5 字节帧头所需的编码比特数
+size_t framePrefixCodedBits(bool fec);
+
+// 从编码比特流开头（至少 framePrefixCodedBits 个）解出帧头：marker（A5 5A）不符时返回 false，
+// 否则给出帧头中的 payload 长度。只用于提前确定帧长 / 快速拒绝，帧的正确性仍以 CRC 为准
+bool peekFrameHeader(
+    const uint8_t* codedBits,
+    size_t count,
+    bool fec,
+    bool tailBiting,
+    DecodeWorkspace& ws,
+    size_t& payloadLen
+);
@@ -0,0 +1,145 @@
+// src/demod.cpp
+#include "demod.h"
+#include "decoder.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr float PI_F = 3.14159265358979323846f;
+
+// 使用 bin index 直接计算 ω = 2π * bin / N，返回 2*cos(ω)
+float goertzelCoeffFromBin(int binIndex, uint32_t N) {
+    if (binIndex <= 0 || binIndex >= static_cast<int>(N / 2)) {
+        throw std::runtime_error("Invalid bin index for Goertzel (must be in (0, N/2))");
+    }
+
+    float omega = 2.0f * PI_F *
+                  static_cast<float>(binIndex) /
+                  static_cast<float>(N);
+    return 2.0f * std::cos(omega);
+}
+
+} // namespace
+
+void checkSubbandBins(int maxBin, int subbands, int stride, uint32_t N, uint32_t sampleRate) {
+    const int64_t top = maxBin + static_cast<int64_t>(subbands - 1) * stride;
+    if (top < static_cast<int64_t>(N / 2)) {
+        return;
+    }
+    // 需要 N / 2 > top，即 N >= 2 * top + 2；按微秒向上取整，保证 N = (uint32_t)(sr * symdur) 不会因舍入少一个
+    const uint64_t needN = static_cast<uint64_t>(2 * top + 2);
+    uint64_t us = (needN * 1000000 + sampleRate - 1) / sampleRate;
+    while (static_cast<uint64_t>(sampleRate * (static_cast<double>(us) / 1e6)) < needN) {
+        ++us;
+    }
+    throw std::runtime_error(
+        "sub-band " + std::to_string(subbands - 1) + " reaches bin " + std::to_string(top) +
+        ", but N = " + std::to_string(N) + " only has bins below " + std::to_string(N / 2) +
+        "; use --symdur >= " + std::to_string(static_cast<double>(us) / 1e6) +
+        " (or fewer --subbands / a smaller --substride / lower --bin*)");
+}
+
+DemodPlan makeDemodPlan(const DecodeParams& params) {
+    uint32_t N = static_cast<uint32_t>(params.sampleRate * params.symbolDurationSec);
+    if (N == 0) {
+        throw std::runtime_error("symbolDurationSec too small for given sampleRate");
+    }
+    if (params.subbands < 1) {
+        throw std::runtime_error("subbands must be >= 1");
+    }
+    if (params.toneBits != 1 && params.toneBits != 2 && params.toneBits != 4) {
+        throw std::runtime_error("toneBits must be 1, 2 or 4");
+    }
+
+    auto mm = std::minmax_element(params.bins.begin(), params.bins.end());
+    int stride = params.subbandStride;
+    if (stride == 0) {
+        stride = *mm.second - *mm.first + 1;
+    } else if (stride < *mm.second - *mm.first + 1) {
+        throw std::runtime_error("subbandStride smaller than bin span, sub-bands would overlap");
+    }
+    checkSubbandBins(*mm.second, params.subbands, stride, N, params.sampleRate);
+
+    DemodPlan plan;
+    plan.N = N;
+    plan.subbands = params.subbands;
+    plan.toneBits = params.toneBits;
+    plan.tonesPerBand = 1 << params.toneBits;
+    const int A = plan.tonesPerBand;
+    plan.coeffs.resize(static_cast<size_t>(params.subbands) * A);
+    plan.bins.resize(plan.coeffs.size());
+    for (int band = 0; band < params.subbands; ++band) {
+        for (int t = 0; t < A; ++t) {
+            const size_t j = static_cast<size_t>(band) * A + t;
+            plan.bins[j] = params.bins[toneBinIndex(t, A)] + band * stride;
+            plan.coeffs[j] = goertzelCoeffFromBin(plan.bins[j], N);
+        }
+    }
+
+    plan.window.resize(N);
+    for (uint32_t i = 0; i < N; ++i) {
+        plan.window[i] = (N > 1)
+            ? 0.5f - 0.5f * std::cos(2.0f * PI_F * static_cast<float>(i) /
+                                     static_cast<float>(N - 1))
+            : 1.0f;
+    }
+    return plan;
+}
+
+void preprocessFrame(float* frame, const DemodPlan& plan) {
+    const uint32_t N = plan.N;
+    if (N == 0) return;
+
+    // 去直流
+    float mean = 0.0f;
+    for (uint32_t i = 0; i < N; ++i) {
+        mean += frame[i];
+    }
+    mean /= static_cast<float>(N);
+
+    // Hann 窗
+    for (uint32_t i = 0; i < N; ++i) {
+        frame[i] = (frame[i] - mean) * plan.window[i];
+    }
+}
+
+void goertzelBank(
+    const float* data,
+    uint32_t N,
+    const std::vector<float>& coeffs,
+    DemodScratch& scratch
+) {
+    scratch.powers.resize(coeffs.size());
+    kernels().goertzelPowers(data, N, coeffs.data(), coeffs.size(), scratch.powers.data());
+}
+
+void pickTones(const float* powers, const DemodPlan& plan, int* symbolsOut) {
+    const int A = plan.tonesPerBand;
+    for (int band = 0; band < plan.subbands; ++band) {
+        const float* p = powers + static_cast<size_t>(band) * A;
+        float bestPower = -1.0f;
+        int bestIdx = 0;
+        for (int i = 0; i < A; ++i) {
+            if (p[i] > bestPower) {
+                bestPower = p[i];
+                bestIdx = i;
+            }
+        }
+        symbolsOut[band] = bestIdx;
+    }
+}
+
+void detectSymbolIndices(
+    const float* frame,
+    const DemodPlan& plan,
+    DemodScratch& scratch,
+    int* symbolsOut
+) {
+    goertzelBank(frame, plan.N, plan.coeffs, scratch);
+    pickTones(scratch.powers.data(), plan, symbolsOut);
+}
@@ -0,0 +1,59 @@
+// src/demod.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct DecodeParams;
+
+// 预计算的 16-FSK 解调计划（只读，可在多个线程/文件间共享）
+// coeffs 下标为 band * tonesPerBand + tone
+struct DemodPlan {
+    uint32_t           N            = 0;   // 每符号采样点数
+    int                subbands     = 1;
+    int                toneBits     = 4;   // 每子带每符号 bit 数
+    int                tonesPerBand = 16;  // 2^toneBits
+    std::vector<float> coeffs;         // Goertzel 系数 2*cos(omega)
+    std::vector<int>   bins;           // coeffs[j] 对应的 DFT bin
+    std::vector<float> window;         // Hann 窗
+};
+
+// 每个解调线程自己的临时缓冲（Goertzel 状态在内核里分块放在寄存器中，这里只存结果）
+struct DemodScratch {
+    std::vector<float> powers;
+};
+
+// 字母表中第 t 个音对应 bins 的下标：在 0..15 上均匀取 tonesPerBand 个
+inline int toneBinIndex(int t, int tonesPerBand) {
+    return tonesPerBand == 1 ? 0 : t * 15 / (tonesPerBand - 1);
+}
+
+// 多子带时最高的 bin（maxBin + (K-1) * stride）须小于 N/2，默认 --symdur 0.001（N = 44）
+// 下 K > 1 都放不下；超出时抛 std::runtime_error，说明最短可用的 --symdur。编码、解码共用
+void checkSubbandBins(int maxBin, int subbands, int stride, uint32_t N, uint32_t sampleRate);
+
+// 根据参数计算符号形状、K * 2^toneBits 个 bin 的 Goertzel 系数和 Hann 窗；
+// 参数非法时抛 std::runtime_error
+DemodPlan makeDemodPlan(const DecodeParams& params);
+
+// 去 DC + Hann 窗（就地处理 plan.N 个 float 样本）
+void preprocessFrame(float* frame, const DemodPlan& plan);
+
+// 一次遍历窗口样本，同时推进所有 bin 的 Goertzel 递推，powers[j] 输出第 j 个 bin 的能量
+// 按 CPU 分派到 baseline / AVX2 / AVX-512 内核（见 kernels.h）
+void goertzelBank(
+    const float* data,
+    uint32_t N,
+    const std::vector<float>& coeffs,
+    DemodScratch& scratch
+);
+
+// 按 plan.coeffs 的顺序排列的各 bin 能量中，每个子带取能量最大的音
+void pickTones(const float* powers, const DemodPlan& plan, int* symbolsOut);
+
+// 对一个（已预处理的）符号窗口做一次频谱扫描，每个子带分别判决音序号 0..tonesPerBand-1
+void detectSymbolIndices(
+    const float* frame,
+    const DemodPlan& plan,
+    DemodScratch& scratch,
+    int* symbolsOut
+);
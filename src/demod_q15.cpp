@@ -0,0 +1,278 @@
+// src/demod_q15.cpp
+#include "demod_q15.h"
+#include "decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// 四分之一周期正弦表，Q30，第 k 项为 sin(kπ / (2·QUARTER))，纯整数生成：
+// 从 (cos, sin) = (1, 0) 起每步旋转 π/(2·QUARTER)，旋转常数是 Q30 整数；
+// 每步同时得到 sin(x) 与 cos(x) = sin(π/2 - x)，只需走半个象限，累积误差约 1e-7（Q15 的 1 LSB 为 3e-5）
+constexpr int      QUARTER_BITS = 10;
+constexpr uint32_t QUARTER      = 1u << QUARTER_BITS;
+constexpr int      FRAC_BITS    = 16;                        // 表项之间线性插值的相位精度
+constexpr int      TURN_BITS    = QUARTER_BITS + 2 + FRAC_BITS;
+constexpr int64_t  ONE_Q30      = int64_t{1} << 30;
+constexpr int64_t  ROT_COS_Q30  = 1073740561;                // round(cos(π/2048) * 2^30)
+constexpr int64_t  ROT_SIN_Q30  = 1647099;                   // round(sin(π/2048) * 2^30)
+
+const std::vector<int32_t>& quarterSineQ30() {
+    static const std::vector<int32_t> table = [] {
+        std::vector<int32_t> t(QUARTER + 1);
+        int64_t c = ONE_Q30;
+        int64_t s = 0;
+        for (uint32_t k = 0; k <= QUARTER / 2; ++k) {
+            t[k] = static_cast<int32_t>(s);
+            t[QUARTER - k] = static_cast<int32_t>(c);
+            const int64_t nc = (c * ROT_COS_Q30 - s * ROT_SIN_Q30 + ONE_Q30 / 2) >> 30;
+            s = (s * ROT_COS_Q30 + c * ROT_SIN_Q30 + ONE_Q30 / 2) >> 30;
+            c = nc;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// sin(kπ / (2·QUARTER))，k 取任意整数（按整周回绕）
+int64_t sineAtQ30(uint32_t k) {
+    const std::vector<int32_t>& t = quarterSineQ30();
+    const uint32_t r = k & (QUARTER - 1);
+    switch ((k >> QUARTER_BITS) & 3) {
+    case 0:  return t[r];
+    case 1:  return t[QUARTER - r];
+    case 2:  return -t[r];
+    default: return -t[QUARTER - r];
+    }
+}
+
+// cos(2π·num/den)，Q30：相位量化到 2^-TURN_BITS 周，在表项之间线性插值
+int64_t cosTurnQ30(uint64_t num, uint64_t den) {
+    const uint64_t turn = uint64_t{1} << TURN_BITS;
+    const uint64_t phase = ((((num % den) << TURN_BITS) + den / 2) / den +
+                            (static_cast<uint64_t>(QUARTER) << FRAC_BITS)) & (turn - 1);   // cos(x) = sin(x + π/2)
+    const uint32_t k = static_cast<uint32_t>(phase >> FRAC_BITS);
+    const int64_t frac = static_cast<int64_t>(phase & ((uint64_t{1} << FRAC_BITS) - 1));
+    const int64_t a = sineAtQ30(k);
+    const int64_t b = sineAtQ30(k + 1);
+    return a + (((b - a) * frac) >> FRAC_BITS);
+}
+
+// Q30 -> Q15（满幅 32767），四舍五入
+int16_t toQ15(int64_t q30) {
+    return static_cast<int16_t>((q30 * 32767 + ONE_Q30 / 2) >> 30);
+}
+
+template <typename State>
+void goertzelBankQ15Impl(const int16_t* data, const DemodPlanQ15& plan, DemodScratchQ15& scratch) {
+    const size_t M = plan.cosQ15.size();
+    const int16_t* c = plan.cosQ15.data();
+
+    // 状态放在栈上的小数组里按块处理，内层循环只有整数乘加
+    constexpr size_t BLOCK = 16;
+    for (size_t j0 = 0; j0 < M; j0 += BLOCK) {
+        const size_t m = std::min(BLOCK, M - j0);
+        State s1[BLOCK] = {};
+        State s2[BLOCK] = {};
+
+        for (uint32_t i = 0; i < plan.N; ++i) {
+            const State x = data[i];
+            for (size_t j = 0; j < m; ++j) {
+                State s = x + static_cast<State>((static_cast<int64_t>(c[j0 + j]) * s1[j]) >> 14) - s2[j];
+                s2[j] = s1[j];
+                s1[j] = s;
+            }
+        }
+
+        for (size_t j = 0; j < m; ++j) {
+            const int64_t a = static_cast<int64_t>(s1[j]) >> plan.powerShift;
+            const int64_t b = static_cast<int64_t>(s2[j]) >> plan.powerShift;
+            const int64_t cross = ((static_cast<int64_t>(c[j0 + j]) * a) >> 14) * b;
+            scratch.powers[j0 + j] = a * a + b * b - cross;
+        }
+    }
+}
+
+} // namespace
+
+DemodPlanQ15 makeDemodPlanQ15(const DemodPlan& plan) {
+    DemodPlanQ15 q;
+    q.N            = plan.N;
+    q.subbands     = plan.subbands;
+    q.toneBits     = plan.toneBits;
+    q.tonesPerBand = plan.tonesPerBand;
+
+    // 系数量化误差 ±0.5 LSB 使谐振频率偏移约 (0.5/32767) / sin(ω) 弧度；
+    // 低频 bin + 长符号时偏移会接近 bin 间隔 2π/N，此时 Q15 无法分辨各音，直接拒绝
+    //（系数直接由 bin / N 查整数正弦表，不经浮点计划的 float 系数；下面只有建计划时的边界检查用浮点）
+    const double binSpacing = 2.0 * 3.14159265358979323846 / plan.N;
+    double minSin = 1.0;
+    q.cosQ15.resize(plan.bins.size());
+    for (size_t j = 0; j < plan.bins.size(); ++j) {
+        q.cosQ15[j] = toQ15(cosTurnQ30(static_cast<uint64_t>(plan.bins[j]), plan.N));
+        const double cosw = q.cosQ15[j] / 32767.0;
+        minSin = std::min(minSin, std::sqrt(std::max(0.0, 1.0 - cosw * cosw)));
+    }
+    if ((0.5 / 32767.0) / std::max(minSin, 1e-9) > 0.1 * binSpacing) {
+        throw std::runtime_error("Q15 coefficient resolution too coarse for these bins "
+                                 "(use shorter symbols or higher bins)");
+    }
+
+    // Hann 窗 (1 - cos(2πi/(N-1))) / 2，同样查表
+    q.window.resize(plan.N);
+    for (uint32_t i = 0; i < plan.N; ++i) {
+        q.window[i] = plan.N > 1
+            ? static_cast<int16_t>(((ONE_Q30 - cosTurnQ30(i, plan.N - 1)) * 32767 + ONE_Q30) >> 31)
+            : int16_t{32767};
+    }
+
+    // 状态上界，见头文件中的溢出分析
+    const double bound = static_cast<double>(plan.N) * 32768.0 / std::max(minSin, 1e-9);
+    if (bound >= std::ldexp(1.0, 48)) {
+        throw std::runtime_error("Symbol too long for Q15 Goertzel (state would overflow)");
+    }
+    q.wideState = 2.0 * bound + 32768.0 >= std::ldexp(1.0, 31);   // 中间量 x + 2cos*s1 也须放得下
+
+    int bits = 0;
+    while (std::ldexp(1.0, bits) <= bound) ++bits;
+    q.powerShift = std::max(0, bits - 30);
+    return q;
+}
+
+void floatToInt16(const float* in, int16_t* out, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        float v = in[i];
+        if (v > 32767.0f) v = 32767.0f;
+        if (v < -32768.0f) v = -32768.0f;
+        out[i] = static_cast<int16_t>(std::lrint(v));
+    }
+}
+
+void preprocessFrameQ15(int16_t* frame, const DemodPlanQ15& plan) {
+    const uint32_t N = plan.N;
+    if (N == 0) return;
+
+    // 去直流（int64 累加，N * 32768 不会溢出）
+    int64_t sum = 0;
+    for (uint32_t i = 0; i < N; ++i) {
+        sum += frame[i];
+    }
+    const int32_t mean = static_cast<int32_t>(sum / static_cast<int64_t>(N));
+
+    // Hann 窗：(x - mean) 在 ±65535 内，乘 Q15 窗后右移 15 位，再饱和到 int16
+    for (uint32_t i = 0; i < N; ++i) {
+        int32_t x = (static_cast<int32_t>(frame[i]) - mean) * plan.window[i];
+        x >>= 15;
+        if (x > 32767) x = 32767;
+        if (x < -32768) x = -32768;
+        frame[i] = static_cast<int16_t>(x);
+    }
+}
+
+void goertzelBankQ15(const int16_t* data, const DemodPlanQ15& plan, DemodScratchQ15& scratch) {
+    scratch.powers.resize(plan.cosQ15.size());
+    if (plan.wideState) {
+        goertzelBankQ15Impl<int64_t>(data, plan, scratch);
+    } else {
+        goertzelBankQ15Impl<int32_t>(data, plan, scratch);
+    }
+}
+
+void detectSymbolIndicesQ15(
+    const int16_t* frame,
+    const DemodPlanQ15& plan,
+    DemodScratchQ15& scratch,
+    int* symbolsOut
+) {
+    goertzelBankQ15(frame, plan, scratch);
+    const int A = plan.tonesPerBand;
+    for (int band = 0; band < plan.subbands; ++band) {
+        const int64_t* p = scratch.powers.data() + static_cast<size_t>(band) * A;
+        int64_t bestPower = INT64_MIN;
+        int bestIdx = 0;
+        for (int i = 0; i < A; ++i) {
+            if (p[i] > bestPower) {
+                bestPower = p[i];
+                bestIdx = i;
+            }
+        }
+        symbolsOut[band] = bestIdx;
+    }
+}
+
+bool compareQ15WithFloat(
+    const DecodeParams& params,
+    uint64_t numSymbols,
+    double amplitude,
+    double noiseRms,
+    uint32_t seed,
+    Q15CheckResult& result
+) {
+    DemodPlan plan;
+    DemodPlanQ15 planQ;
+    try {
+        plan = makeDemodPlan(params);
+        planQ = makeDemodPlanQ15(plan);
+    } catch (const std::exception& e) {
+        std::cerr << "Error in makeDemodPlan: " << e.what() << "\n";
+        return false;
+    }
+
+    const uint32_t N = plan.N;
+    const int K = plan.subbands;
+    const int A = plan.tonesPerBand;
+
+    // 直接由计划中的 ω（2cos(ω) 系数）合成音，与解调器看到的频点完全一致
+    std::vector<double> omegas(plan.coeffs.size());
+    for (size_t j = 0; j < omegas.size(); ++j) {
+        omegas[j] = std::acos(std::max(-1.0, std::min(1.0, plan.coeffs[j] / 2.0)));
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> toneDist(0, A - 1);
+    std::uniform_real_distribution<double> phaseDist(0.0, 2.0 * 3.14159265358979323846);
+    std::normal_distribution<double> noise(0.0, noiseRms > 0.0 ? noiseRms : 1.0);
+
+    std::vector<double> mix(N);
+    std::vector<float> frameF(N);
+    std::vector<int16_t> frameQ(N);
+    std::vector<int> truth(K), symF(K), symQ(K);
+    DemodScratch scratch;
+    DemodScratchQ15 scratchQ;
+
+    result = Q15CheckResult{};
+    for (uint64_t s = 0; s < numSymbols; ++s) {
+        std::fill(mix.begin(), mix.end(), 0.0);
+        for (int band = 0; band < K; ++band) {
+            truth[band] = toneDist(rng);
+            const double w = omegas[static_cast<size_t>(band) * A + truth[band]];
+            const double ph = phaseDist(rng);
+            for (uint32_t n = 0; n < N; ++n) {
+                mix[n] += amplitude / K * std::sin(w * n + ph);
+            }
+        }
+        for (uint32_t n = 0; n < N; ++n) {
+            double v = mix[n] + (noiseRms > 0.0 ? noise(rng) : 0.0);
+            v = std::max(-32768.0, std::min(32767.0, std::round(v)));
+            frameF[n] = static_cast<float>(v);
+            frameQ[n] = static_cast<int16_t>(v);
+        }
+
+        preprocessFrame(frameF.data(), plan);
+        detectSymbolIndices(frameF.data(), plan, scratch, symF.data());
+        preprocessFrameQ15(frameQ.data(), planQ);
+        detectSymbolIndicesQ15(frameQ.data(), planQ, scratchQ, symQ.data());
+
+        for (int band = 0; band < K; ++band) {
+            ++result.symbols;
+            if (symF[band] != symQ[band]) ++result.mismatches;
+            if (symF[band] != truth[band]) ++result.floatErrors;
+            if (symQ[band] != truth[band]) ++result.q15Errors;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+// src/demod_q15.h
+#pragma once
+#include "demod.h"
+
+#include <cstdint>
+#include <vector>
+
+// 定点（Q15）解调路径：接口与 demod.h 一一对应，只用整数运算，供无 FPU 的接收端使用
+//
+// 数值格式与溢出分析：
+//   样本        int16（WavReader 直接读出，16-bit PCM 不经浮点），去 DC 后乘 Q15 Hann 窗，饱和到 int16
+//   系数 / 窗   由纯整数生成的 Q30 正弦表插值后取 Q15，不经浮点
+//   系数        cosQ15 = round(cos(ω) * 32767)，递推中 2cos(ω)*s = (cosQ15 * s) >> 14；
+//               量化造成的频率偏移超过 0.1 个 bin 间隔时（低 bin + 长符号）拒绝建计划
+//   状态 s      Goertzel 谐振器的冲激响应为 sin((n+1)ω)/sin(ω)，
+//               因此 |s| <= N * 32768 / min|sin(ω)|。递推的中间量 x + 2cos(ω)*s1 可达
+//               2 * 上界 + 32768（减去 s2 之前），它 < 2^31 时用 int32 状态，否则用 int64 状态。
+//               乘积 cosQ15 * s < 2^15 * max|s|，要求上界 < 2^48，超出时（N 达到百万量级）拒绝建计划
+//   能量        P = s1^2 + s2^2 - 2cos*s1*s2 ≤ 4 * max|s|^2。先把 s 右移 powerShift 位
+//               使 |s| < 2^30，各项 < 2^60，和 < 2^62，int64 不溢出；判决只比较相对大小，
+//               统一右移不影响 argmax
+struct DemodPlanQ15 {
+    uint32_t             N            = 0;
+    int                  subbands     = 1;
+    int                  toneBits     = 4;
+    int                  tonesPerBand = 16;
+    std::vector<int16_t> cosQ15;        // cos(ω)，Q15，下标同 DemodPlan::coeffs
+    std::vector<int16_t> window;        // Hann 窗，Q15
+    bool                 wideState   = false;   // true = int64 状态
+    int                  powerShift  = 0;
+};
+
+// 递推状态按块放在栈上，scratch 只保存各 bin 的能量
+struct DemodScratchQ15 {
+    std::vector<int64_t> powers;
+};
+
+// 取浮点计划的 bin / N / 子带（保证两条路径解调的是同一组频点），系数与窗按整数表重新算
+DemodPlanQ15 makeDemodPlanQ15(const DemodPlan& plan);
+
+// 浮点样本（±32768 满幅）转 int16，四舍五入并饱和（重采样输出、内存中的 float 缓冲用）
+void floatToInt16(const float* in, int16_t* out, uint32_t n);
+
+// 去 DC + Hann 窗（就地处理 plan.N 个 int16 样本）
+void preprocessFrameQ15(int16_t* frame, const DemodPlanQ15& plan);
+
+// 所有 bin 共享一次样本遍历的定点 Goertzel，scratch.powers[j] 输出第 j 个 bin 的能量
+void goertzelBankQ15(const int16_t* data, const DemodPlanQ15& plan, DemodScratchQ15& scratch);
+
+void detectSymbolIndicesQ15(
+    const int16_t* frame,
+    const DemodPlanQ15& plan,
+    DemodScratchQ15& scratch,
+    int* symbolsOut
+);
+
+// 定点/浮点一致性检查：按 params 生成随机符号的合成信号（可加高斯白噪声），
+// 分别用两条路径判决，统计不一致数与各自相对真值的错误数
+struct Q15CheckResult {
+    uint64_t symbols     = 0;
+    uint64_t mismatches  = 0;   // 定点与浮点判决不同
+    uint64_t floatErrors = 0;
+    uint64_t q15Errors   = 0;
+};
+
+bool compareQ15WithFloat(
+    const DecodeParams& params,
+    uint64_t numSymbols,
+    double amplitude,
+    double noiseRms,
+    uint32_t seed,
+    Q15CheckResult& result
+);
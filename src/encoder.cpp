@@ -1,8 +1,13 @@
 // src/encoder.cpp
 #include "encoder.h"
 #include "wav_io.h"
+#include "async_io.h"
 #include "fec.h"
 #include "frame.h"
+#include "frame_index.h"
+#include "lz.h"
+#include "rate_mode.h"
+#include "demod.h"
 
 #include <vector>
 #include <cstdint>
@@ -10,9 +15,9 @@
 #include <iostream>
 #include <cmath>
 #include <stdexcept>
-#include <limits>
 #include <iterator>
 #include <array>
+#include <algorithm>
 
 namespace {
 
@@ -30,87 +35,162 @@ SymbolShape computeSymbolShape(uint32_t sampleRate, double symbolDurationSec) {
     return { N };
 }
 
-// 预计算 16 个频率对应的“一个符号波形” LUT
+// 子带间隔：未指定时取 bins 的跨度，保证相邻子带互不重叠
+int resolveSubbandStride(const EncodeParams& params) {
+    auto mm = std::minmax_element(params.bins.begin(), params.bins.end());
+    int span = *mm.second - *mm.first + 1;
+    if (params.subbandStride == 0) {
+        return span;
+    }
+    if (params.subbandStride < span) {
+        throw std::runtime_error("subbandStride smaller than bin span, sub-bands would overlap");
+    }
+    return params.subbandStride;
+}
+
+// 预计算 K * 2^toneBits 个频率对应的“一个符号波形” LUT
 // 频率来自 DFT bin: f_k = bin * Fs / N
+// K 个子带同时发声，每个音的幅度取 floor(amplitude / K)：逐样本取整后 |w| 不超过这个整数，
+// K 个音之和不超过 amplitude，叠加后不会削波
 void buildSymbolLUT(
-    std::array<std::vector<int16_t>, 16>& waves,
-    const EncodeParams& params,
-    const SymbolShape& shape
+    SymbolLUT& lut,
+    const EncodeParams& params
 ) {
+    if (params.subbands < 1) {
+        throw std::runtime_error("subbands must be >= 1");
+    }
+    if (params.toneBits != 1 && params.toneBits != 2 && params.toneBits != 4) {
+        throw std::runtime_error("toneBits must be 1, 2 or 4");
+    }
+    const SymbolShape shape = computeSymbolShape(params.sampleRate, params.symbolDurationSec);
+    const int stride = resolveSubbandStride(params);
+    checkSubbandBins(*std::max_element(params.bins.begin(), params.bins.end()), params.subbands, stride,
+                     shape.N, params.sampleRate);
+
     double binWidth = static_cast<double>(params.sampleRate) /
                       static_cast<double>(shape.N);
+    double toneAmp  = std::floor(static_cast<double>(params.amplitude) / params.subbands);
 
-    for (int i = 0; i < 16; ++i) {
-        int bin = params.bins[i];
-        if (bin <= 0 || bin >= static_cast<int>(shape.N / 2)) {
-            throw std::runtime_error("Invalid bin index for 16-FSK (must be in (0, N/2))");
-        }
+    lut.N            = shape.N;
+    lut.subbands     = params.subbands;
+    lut.tonesPerBand = 1 << params.toneBits;
+    lut.waves.assign(static_cast<size_t>(lut.subbands) * lut.tonesPerBand, {});
 
-        double f = bin * binWidth;
-        waves[i].resize(shape.N);
+    for (int band = 0; band < lut.subbands; ++band) {
+        for (int t = 0; t < lut.tonesPerBand; ++t) {
+            int bin = params.bins[toneBinIndex(t, lut.tonesPerBand)] + band * stride;
+            if (bin <= 0 || bin >= static_cast<int>(shape.N / 2)) {
+                throw std::runtime_error("Invalid bin index for 16-FSK (must be in (0, N/2))");
+            }
 
-        for (uint32_t n = 0; n < shape.N; ++n) {
-            double t = static_cast<double>(n) / params.sampleRate;
-            double v = params.amplitude * std::sin(2.0 * PI * f * t);
-            waves[i][n] = static_cast<int16_t>(std::round(v));
+            double f = bin * binWidth;
+            auto& w = lut.waves[static_cast<size_t>(band) * lut.tonesPerBand + t];
+            w.resize(shape.N);
+
+            for (uint32_t n = 0; n < shape.N; ++n) {
+                double tt = static_cast<double>(n) / params.sampleRate;
+                double v = toneAmp * std::sin(2.0 * PI * f * tt);
+                w[n] = static_cast<int16_t>(std::round(v));
+            }
         }
     }
 }
 
-// 写一个符号
-inline void writeSymbol(
-    std::ofstream& ofs,
-    const std::array<std::vector<int16_t>, 16>& waves,
-    int symbolIndex
+// 写一个符号：symbols[band] 为各子带在字母表中的音序号
+// 单子带直接写 LUT，多子带先在 mix 中叠加（int32 累加后饱和到 int16，幅度按上面的分配本不会超出）
+inline bool writeSymbol(
+    AsyncWriter& out,
+    const SymbolLUT& lut,
+    const uint8_t* symbols,
+    std::vector<int16_t>& mix
 ) {
-    const auto& w = waves[symbolIndex & 0xF];
-    ofs.write(reinterpret_cast<const char*>(w.data()),
-              static_cast<std::streamsize>(w.size() * sizeof(int16_t)));
-}
+    const int mask = lut.tonesPerBand - 1;
+    if (lut.subbands == 1) {
+        const auto& w = lut.waves[symbols[0] & mask];
+        return out.write(w.data(), w.size() * sizeof(int16_t));
+    }
 
-// 构造 WAV 头
-WavHeader makeWavHeader(uint32_t sampleRate, uint64_t totalSamples) {
-    WavHeader header{};
-    header.riff[0] = 'R'; header.riff[1] = 'I';
-    header.riff[2] = 'F'; header.riff[3] = 'F';
-    header.wave[0] = 'W'; header.wave[1] = 'A';
-    header.wave[2] = 'V'; header.wave[3] = 'E';
-    header.fmt[0]  = 'f'; header.fmt[1]  = 'm';
-    header.fmt[2]  = 't'; header.fmt[3]  = ' ';
-    header.data[0] = 'd'; header.data[1] = 'a';
-    header.data[2] = 't'; header.data[3] = 'a';
-
-    header.subchunk1Size = 16;
-    header.audioFormat   = 1;
-    header.numChannels   = 1;
-    header.sampleRate    = sampleRate;
-    header.bitsPerSample = 16;
-    header.byteRate      = sampleRate * header.numChannels * header.bitsPerSample / 8;
-    header.blockAlign    = header.numChannels * header.bitsPerSample / 8;
-
-    uint64_t dataBytes = totalSamples * header.blockAlign;
-    if (dataBytes > std::numeric_limits<uint32_t>::max()) {
-        throw std::runtime_error("WAV data too large (>4GB), not supported");
-    }
-
-    header.subchunk2Size = static_cast<uint32_t>(dataBytes);
-    header.chunkSize     = 36 + header.subchunk2Size;
-    return header;
+    const size_t N = lut.N;
+    mix.resize(N);
+    for (size_t n = 0; n < N; ++n) {
+        int32_t sum = 0;
+        for (int band = 0; band < lut.subbands; ++band) {
+            sum += lut.waves[static_cast<size_t>(band) * lut.tonesPerBand + (symbols[band] & mask)][n];
+        }
+        mix[n] = static_cast<int16_t>(std::min<int32_t>(32767, std::max<int32_t>(-32768, sum)));
+    }
+    return out.write(mix.data(), N * sizeof(int16_t));
 }
 
 } // namespace
 
+bool buildEncoderPlan(const EncodeParams& params, EncoderPlan& plan) {
+    if (params.rateModeId >= RATE_MODE_COUNT) {
+        std::cerr << "Invalid rate mode: " << params.rateModeId << "\n";
+        return false;
+    }
+    const bool adaptive = params.rateModeId >= 0;
+    if (adaptive && params.subbands != 1) {
+        std::cerr << "Adaptive rate modes require --subbands 1\n";
+        return false;
+    }
+    if (params.frameBytes > 0xFFFF - FRAME_EXT_BYTES) {
+        std::cerr << "Frame size too large (max " << 0xFFFF - FRAME_EXT_BYTES << " bytes)\n";
+        return false;
+    }
+    if (!params.indexPath.empty() && params.frameBytes == 0) {
+        std::cerr << "A frame index requires a multi-frame stream (--frame-size)\n";
+        return false;
+    }
+
+    try {
+        buildSymbolLUT(plan.preamble, params);
+        if (adaptive) {
+            plan.params = applyRateMode(params, params.rateModeId);
+            buildSymbolLUT(plan.header, modeHeaderParams(params));
+            buildSymbolLUT(plan.data, plan.params);
+        } else {
+            plan.params = params;
+            plan.header = SymbolLUT{};
+            plan.data   = plan.preamble;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error in buildSymbolLUT: " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
 bool encodeFileToWav(
     const std::string& inputBinPath,
     const std::string& outputWavPath,
     const EncodeParams& params
 ) {
-    // 1. 读取原始二进制 -> payload
-    std::ifstream ifs(inputBinPath, std::ios::binary);
-    if (!ifs) {
-        std::cerr << "Failed to open input file: " << inputBinPath << "\n";
+    EncoderPlan plan;
+    if (!buildEncoderPlan(params, plan)) {
         return false;
     }
+    return encodeFileToWav(inputBinPath, outputWavPath, plan);
+}
+
+bool encodeFileToWav(
+    const std::string& inputBinPath,
+    const std::string& outputWavPath,
+    const EncoderPlan& plan
+) {
+    const EncodeParams& params = plan.params;
+    const bool toStdout = (outputWavPath == "-");
+
+    // 1. 读取原始二进制 -> payload（"-" 为 stdin）
+    std::ifstream file;
+    if (inputBinPath != "-") {
+        file.open(inputBinPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to open input file: " << inputBinPath << "\n";
+            return false;
+        }
+    }
+    std::istream& ifs = (inputBinPath == "-") ? std::cin : file;
     std::vector<uint8_t> payload(
         (std::istreambuf_iterator<char>(ifs)),
         std::istreambuf_iterator<char>()
@@ -120,92 +200,194 @@ bool encodeFileToWav(
         return false;
     }
 
-    // 2. 构造单帧（加帧头 + CRC）
-    uint8_t seq = 0; // 单帧场景，先用 0
-    std::vector<uint8_t> frame = buildFrame(payload, seq);
+    const size_t rawSize = payload.size();
 
-    // 3. 帧字节 -> bit 流
-    std::vector<uint8_t> bits;
-    bytesToBits(frame, bits);  // bits.size() = 8 * frame.size()
-
-    // 4. 卷积编码 FEC
-    std::vector<uint8_t> codedBits;
-    convEncode(bits, codedBits);
-
-    if (codedBits.size() % 4 != 0) {
-        std::cerr << "Internal error: codedBits.size() not multiple of 4\n";
-        return false;
-    }
-    const uint64_t dataSymbols = codedBits.size() / 4; // 每 4bit 一个 symbol
-
-    // 5. 符号形状 + LUT
-    SymbolShape shape;
+    // 2..3. 组帧：单帧时整体（可选压缩）成一帧；多帧时按 frameBytes 切分，
+    //       每帧在扩展头之后各自压缩，任一帧都能单独解出
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<uint32_t> frameDataBytes;   // 各帧数据（解压后）字节数，写索引用
+    size_t packedBytes = 0;
     try {
-        shape = computeSymbolShape(params.sampleRate, params.symbolDurationSec);
+        if (params.frameBytes == 0) {
+            uint8_t seq = 0; // 单帧场景，先用 0
+            if (params.compress) {
+                std::vector<uint8_t> packed;
+                if (lzCompress(payload, packed)) {
+                    payload.swap(packed);
+                    seq |= FRAME_FLAG_COMPRESSED;
+                }
+            }
+            packedBytes = payload.size();
+            frames.push_back(buildFrame(payload, seq));
+            frameDataBytes.push_back(static_cast<uint32_t>(rawSize));
+        } else {
+            if (rawSize > UINT32_MAX) {
+                std::cerr << "Input too large for a multi-frame stream (4 GiB limit).\n";
+                return false;
+            }
+            std::vector<uint8_t> chunk;
+            std::vector<uint8_t> packed;
+            std::vector<uint8_t> framePayload;
+            for (size_t off = 0, k = 0; off < rawSize; off += params.frameBytes, ++k) {
+                const size_t len = std::min<size_t>(params.frameBytes, rawSize - off);
+                chunk.assign(payload.begin() + static_cast<std::ptrdiff_t>(off),
+                             payload.begin() + static_cast<std::ptrdiff_t>(off + len));
+                uint8_t seq = static_cast<uint8_t>((k & FRAME_SEQ_MASK) | FRAME_FLAG_EXTENDED);
+                const std::vector<uint8_t>* data = &chunk;
+                if (params.compress && lzCompress(chunk, packed)) {
+                    data = &packed;
+                    seq |= FRAME_FLAG_COMPRESSED;
+                }
+
+                framePayload.clear();
+                putFrameExtHeader(framePayload, {static_cast<uint32_t>(off), static_cast<uint32_t>(rawSize)});
+                framePayload.insert(framePayload.end(), data->begin(), data->end());
+                packedBytes += data->size();
+                frames.push_back(buildFrame(framePayload, seq));
+                frameDataBytes.push_back(static_cast<uint32_t>(len));
+            }
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         return false;
     }
 
-    std::array<std::vector<int16_t>, 16> waves;
-    try {
-        buildSymbolLUT(waves, params, shape);
-    } catch (const std::exception& e) {
-        std::cerr << "Error in buildSymbolLUT: " << e.what() << "\n";
-        return false;
+    // 每个符号携带 K * toneBits bit，每帧的编码比特各自补 0 到整符号
+    // （补在尾比特之后，Viterbi 从状态 0 输入 0 仍停留在状态 0，不影响解码；
+    // 咬尾码没有尾比特，解码端按帧头长度只取帧本身的比特），因此每帧都从符号边界开始
+    const SymbolLUT& data = plan.data;
+    const size_t toneBits = static_cast<size_t>(params.toneBits);
+    const size_t bitsPerSymbol = static_cast<size_t>(data.subbands) * toneBits;
+    auto frameSymbols = [&](const std::vector<uint8_t>& frame) {
+        const size_t infoBits = frame.size() * 8;
+        const size_t tail = params.tailBiting ? 0 : 2;                     // 零尾卷积码含 2 个尾比特
+        const size_t coded = params.fec ? 2 * (infoBits + tail) : infoBits;
+        return static_cast<uint64_t>((coded + bitsPerSymbol - 1) / bitsPerSymbol);
+    };
+    uint64_t dataSymbols = 0;
+    for (const auto& frame : frames) {
+        dataSymbols += frameSymbols(frame);
     }
 
-    uint64_t totalSymbols = static_cast<uint64_t>(params.syncSymbols) + dataSymbols;
-    uint64_t totalSamples = totalSymbols * shape.N;
-
-    // 6. 写 WAV 头
-    WavHeader header;
-    try {
-        header = makeWavHeader(params.sampleRate, totalSamples);
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << "\n";
-        return false;
+    // 6. 符号形状 + LUT 已在 plan 中预计算
+    const bool adaptive = params.rateModeId >= 0;
+    uint64_t totalSamples = static_cast<uint64_t>(params.syncSymbols) * plan.preamble.N
+                          + dataSymbols * data.N;
+    if (adaptive) {
+        totalSamples += static_cast<uint64_t>(MODE_HEADER_SYMBOLS) * plan.header.N;
     }
 
-    std::ofstream ofs(outputWavPath, std::ios::binary);
-    if (!ofs) {
+    // 7. 写 WAV 头（超过 4GB 时自动使用 RF64；裸 PCM 不写头）
+    //    PCM 经 AsyncWriter 写出：符号合成填满一块就交给后台写盘，继续合成下一块
+    AsyncWriter out;
+    if (!out.open(outputWavPath)) {
         std::cerr << "Failed to open WAV for writing: " << outputWavPath << "\n";
         return false;
     }
-    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
-    if (!ofs) {
-        std::cerr << "Failed to write WAV header.\n";
-        return false;
+
+    if (!params.rawPcm) {
+        std::vector<uint8_t> header = makeWavHeaderMono16(params.sampleRate, totalSamples);
+        if (!out.write(header.data(), header.size())) {
+            std::cerr << "Failed to write WAV header.\n";
+            return false;
+        }
     }
 
-    // 7. 写前导同步符号（0 和 15 交替）
+    std::vector<uint8_t> symbols(static_cast<size_t>(std::max(data.subbands, plan.preamble.subbands)));
+    std::vector<int16_t> mix;
+
+    // 8. 写前导同步符号（音 0 和音 15 交替，所有子带相同）
     for (int i = 0; i < params.syncSymbols; ++i) {
-        int sym = (i % 2 == 0) ? 0 : 15;
-        writeSymbol(ofs, waves, sym);
-        if (!ofs) {
+        uint8_t sym = static_cast<uint8_t>((i % 2 == 0) ? 0 : plan.preamble.tonesPerBand - 1);
+        std::fill(symbols.begin(), symbols.end(), sym);
+        if (!writeSymbol(out, plan.preamble, symbols.data(), mix)) {
             std::cerr << "Failed while writing sync symbols.\n";
             return false;
         }
     }
+    uint64_t sampleOffset = static_cast<uint64_t>(params.syncSymbols) * plan.preamble.N;
+
+    // 8b. 自适应模式：写模式头
+    if (adaptive) {
+        for (uint8_t sym : modeHeaderSymbols(params.rateModeId)) {
+            if (!writeSymbol(out, plan.header, &sym, mix)) {
+                std::cerr << "Failed while writing mode header.\n";
+                return false;
+            }
+        }
+        sampleOffset += static_cast<uint64_t>(MODE_HEADER_SYMBOLS) * plan.header.N;
+    }
 
-    // 8. 写数据符号：每 4 bit -> 1 个 0..15 的 symbolIndex
-    for (uint64_t symIdx = 0; symIdx < dataSymbols; ++symIdx) {
-        size_t base = static_cast<size_t>(symIdx * 4);
-        uint8_t b3 = codedBits[base]     & 0x1; // 最高 bit
-        uint8_t b2 = codedBits[base + 1] & 0x1;
-        uint8_t b1 = codedBits[base + 2] & 0x1;
-        uint8_t b0 = codedBits[base + 3] & 0x1; // 最低 bit
+    FrameIndex index;
+    index.sampleRate    = params.sampleRate;
+    index.symbolSamples = data.N;
+    index.rateModeId    = params.rateModeId;
+    index.totalBytes    = rawSize;
 
-        uint8_t symbolIndex = static_cast<uint8_t>((b3 << 3) | (b2 << 2) | (b1 << 1) | b0);
-        writeSymbol(ofs, waves, symbolIndex);
-        if (!ofs) {
-            std::cerr << "Failed while writing data symbols.\n";
-            return false;
+    // 9. 逐帧：帧字节 -> bit 流 -> 卷积编码 FEC（fec=false 时直接发送帧 bit）-> 数据符号
+    //    子带 k 取第 k 组 toneBits 个 bit（高位在前）-> 音序号
+    std::vector<uint8_t> bits;
+    std::vector<uint8_t> codedBits;
+    uint64_t byteOffset = 0;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        bytesToBits(frames[f], bits);  // bits.size() = 8 * frame.size()
+        if (params.fec && params.tailBiting) {
+            convEncodeTailBiting(bits, codedBits);
+        } else if (params.fec) {
+            convEncode(bits, codedBits);
+        } else {
+            codedBits.swap(bits);
         }
+        const uint64_t frameSyms = frameSymbols(frames[f]);
+        codedBits.resize(static_cast<size_t>(frameSyms * bitsPerSymbol), 0);
+
+        for (uint64_t symIdx = 0; symIdx < frameSyms; ++symIdx) {
+            size_t base = static_cast<size_t>(symIdx * bitsPerSymbol);
+            for (int band = 0; band < data.subbands; ++band) {
+                size_t b = base + static_cast<size_t>(band) * toneBits;
+                uint8_t v = 0;
+                for (size_t k = 0; k < toneBits; ++k) {
+                    v = static_cast<uint8_t>((v << 1) | (codedBits[b + k] & 0x1));
+                }
+                symbols[band] = v;
+            }
+            if (!writeSymbol(out, data, symbols.data(), mix)) {
+                std::cerr << "Failed while writing data symbols.\n";
+                return false;
+            }
+        }
+
+        index.frames.push_back({byteOffset, frameDataBytes[f], sampleOffset,
+                                static_cast<uint32_t>(frameSyms)});
+        byteOffset   += frameDataBytes[f];
+        sampleOffset += frameSyms * data.N;
     }
 
-    std::cout << "Encoded " << payload.size()
-              << " bytes payload (frame+FEC+16-FSK DFT-bin) to "
-              << outputWavPath << "\n";
+    if (!out.close()) {
+        std::cerr << "Failed to flush WAV output.\n";
+        return false;
+    }
+
+    if (!params.indexPath.empty() && !writeFrameIndex(params.indexPath, index)) {
+        return false;
+    }
+
+    if (params.verbose) {
+        std::ostream& status = toStdout ? std::cerr : std::cout;
+        status << "Encoded " << rawSize;
+        if (packedBytes < rawSize) {
+            status << " bytes payload (compressed to " << packedBytes << ")";
+        } else {
+            status << " bytes payload";
+        }
+        if (params.frameBytes > 0) {
+            status << " in " << frames.size() << " frames";
+        }
+        if (adaptive) {
+            status << " [rate mode " << params.rateModeId << ": "
+                   << rateMode(params.rateModeId).name << "]";
+        }
+        status << " (frame+FEC+16-FSK DFT-bin) to " << outputWavPath << "\n";
+    }
     return true;
 }
\ No newline at end of file
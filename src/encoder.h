@@ -3,8 +3,9 @@
 #include <string>
 #include <cstdint>
 #include <array>
+#include <vector>
 
-// 16-FSK 编码参数：一个符号携带 4 bit
+// 16-FSK 编码参数：一个符号携带 4 bit（默认）
 // 使用 DFT bin 对齐的频率：f_k = bin * Fs / N
 struct EncodeParams {
     double   symbolDurationSec = 0.001;       // 符号时长（秒）
@@ -21,10 +22,72 @@ struct EncodeParams {
         11, 12, 13, 14,
         15, 16, 17, 18
     };
+
+    // 并行子带数 K：每个符号窗口内 K 个子带同时各发一个 16-FSK 符号，一符号携带 4K bit
+    // 子带 k 中符号 i 的 bin 为 bins[i] + k * subbandStride
+    // 注意：最高 bin (max(bins) + (K-1)*stride) 同样必须小于 N/2
+    int      subbands          = 1;
+    int      subbandStride     = 0;           // 子带间隔（bin 数），0 = 自动取 bins 跨度
+
+    // 字母表：每个子带每符号携带的 bit 数。4 = 16-FSK；2 = 4-FSK（只用音 0,5,10,15）；
+    // 1 = 2-FSK（音 0,15）。音间隔越大越抗干扰
+    int      toneBits          = 4;
+    bool     fec               = true;        // 卷积码 FEC（rate 1/2）；false = 不编码
+
+    // 咬尾卷积码：编码器从每帧最后 2 个信息比特起步，省掉 2 个尾比特（4 个编码比特），
+    // 解码端需同样设置。多为短帧配合短前导使用（--short）
+    bool     tailBiting        = false;
+
+    // 自适应速率：>= 0 时在前导之后发送模式头，数据段按 rateMode(rateModeId) 换算参数
+    // （见 rate_mode.h）；-1 = 传统固定参数，不发送模式头
+    int      rateModeId        = -1;
+
+    // 组帧前对 payload 做 LZ 压缩；压缩后不变小则按原样存储（帧头不置压缩标志）
+    bool     compress          = false;
+
+    // 多帧：payload 按每帧最多 frameBytes 字节切分，每帧带扩展头（流内偏移 / 总长，见 frame.h），
+    // 解码端可以只解某个字节区间；0 = 单帧（payload 上限 64 KiB）
+    uint32_t frameBytes        = 0;
+
+    // 非空时写出边车帧索引（见 frame_index.h），需要 frameBytes > 0
+    std::string indexPath;
+
+    // 输出无文件头的裸 PCM（16-bit 小端单声道），便于接到只吃 PCM 的管道工具
+    bool     rawPcm            = false;
+
+    bool     verbose           = true;        // 打印每个文件的进度信息（批处理时关闭）
 };
 
+// 一种符号形状的波形 LUT，waves 下标为 band * tonesPerBand + tone
+struct SymbolLUT {
+    uint32_t                           N            = 0;
+    int                                subbands     = 1;
+    int                                tonesPerBand = 16;
+    std::vector<std::vector<int16_t>>  waves;
+};
+
+// 预计算的编码计划（符号形状 + 波形 LUT），参数相同的多个文件可共享，构造后只读
+// 非自适应模式下 preamble 与 data 相同，header 为空
+struct EncoderPlan {
+    EncodeParams params;        // 数据段参数（自适应模式下已按速率模式换算）
+    SymbolLUT    preamble;      // 前导同步符号
+    SymbolLUT    header;        // 模式头（仅自适应模式）
+    SymbolLUT    data;          // 数据符号
+};
+
+// 参数非法时打印原因并返回 false
+bool buildEncoderPlan(const EncodeParams& params, EncoderPlan& plan);
+
+// inputBinPath / outputWavPath 为 "-" 时使用 stdin / stdout（此时进度信息改写到 stderr）。
+// payload 先整体读入，总样本数在写头之前已知，因此 WAV 头一次写对，输出无需 seek
 bool encodeFileToWav(
     const std::string& inputBinPath,
     const std::string& outputWavPath,
     const EncodeParams& params = {}
+);
+
+bool encodeFileToWav(
+    const std::string& inputBinPath,
+    const std::string& outputWavPath,
+    const EncoderPlan& plan
 );
\ No newline at end of file
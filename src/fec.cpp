@@ -66,101 +66,177 @@ void convEncode(const std::vector<uint8_t>& inBits, std::vector<uint8_t>& outBit
     }
 }
 
-// -------------------- Viterbi 解码 --------------------
-
-bool convDecode(const std::vector<uint8_t>& inBits, std::vector<uint8_t>& outBits) {
+void convEncodeTailBiting(const std::vector<uint8_t>& inBits, std::vector<uint8_t>& outBits) {
     outBits.clear();
-    if (inBits.empty() || (inBits.size() % 2) != 0) {
-        return false;
+    if (inBits.empty()) return;
+
+    // 初始状态取最后 K-1 个信息比特，编码结束时状态恰好回到起点，不需要尾比特
+    const size_t L = inBits.size();
+    uint8_t state = static_cast<uint8_t>(((inBits[L - 1] & 0x1) << 1) | (inBits[(2 * L - 2) % L] & 0x1));
+    outBits.reserve(2 * L);
+    for (uint8_t b : inBits) {
+        convEncodeBit(b & 0x1, state, outBits);
     }
+}
 
-    constexpr int K = 3;
-    constexpr int NUM_STATES = 1 << (K - 1); // 4
-    const int INF = std::numeric_limits<int>::max() / 4;
+// -------------------- Viterbi 解码 --------------------
 
-    size_t steps = inBits.size() / 2; // 每两比特对应一个时刻
+namespace {
 
-    // pathMetric[t][s]
-    std::vector<std::array<int, NUM_STATES>> pathMetric(steps + 1);
-    std::vector<std::array<uint8_t, NUM_STATES>> prevState(steps + 1);
-    std::vector<std::array<uint8_t, NUM_STATES>> prevInputBit(steps + 1);
+constexpr int K = 3;
+constexpr int NUM_STATES = 1 << (K - 1); // 4
+constexpr int INF = std::numeric_limits<int>::max() / 4;
 
-    for (int s = 0; s < NUM_STATES; ++s) {
-        pathMetric[0][s] = (s == 0) ? 0 : INF; // 初始状态为 0
-    }
+// 咬尾解码时在码流前后各绕回的时刻数：约 5 倍约束长度之后幸存路径已合并，
+// 起点状态由绕回段“学”出来，终点不再需要尾比特
+constexpr size_t TAIL_BITING_WRAP = 24;
 
-    // 预计算转移
-    struct Branch {
-        uint8_t out0;
-        uint8_t out1;
-        uint8_t nextState;
-    };
-    std::array<std::array<Branch, 2>, NUM_STATES> branches{};
-    for (int s = 0; s < NUM_STATES; ++s) {
-        uint8_t s1 = (s >> 1) & 0x1;
-        uint8_t s2 =  s       & 0x1;
-        for (int u = 0; u < 2; ++u) {
-            uint8_t uu = static_cast<uint8_t>(u);
-            uint8_t v0 = uu ^ s1 ^ s2;          // G1
-            uint8_t v1 = uu ^ s2;               // G2
-            uint8_t ns = static_cast<uint8_t>(((uu & 0x1) << 1) | s1);
-
-            branches[s][u] = Branch{v0, v1, ns};
+using PathMetrics = std::array<int, NUM_STATES>;
+
+// 各状态、各前驱分支的期望输出 (v0, v1)
+struct BranchTable {
+    std::array<std::array<uint8_t, 2>, NUM_STATES> out0{}, out1{};
+
+    BranchTable() {
+        for (int ns = 0; ns < NUM_STATES; ++ns) {
+            uint8_t u  = static_cast<uint8_t>(ns >> 1);
+            uint8_t s1 = static_cast<uint8_t>(ns & 0x1);
+            for (int s2 = 0; s2 < 2; ++s2) {
+                out0[ns][s2] = static_cast<uint8_t>(u ^ s1 ^ s2);   // G1
+                out1[ns][s2] = static_cast<uint8_t>(u ^ s2);        // G2
+            }
         }
     }
-
-    // 递推
+};
+
+// 递推（add-compare-select）steps 个时刻：时刻 t 读取第 (first + t) % period 对接收比特，
+// 判决写入 survivors[t]。平局时取 s2=0，与逐状态正向展开时“先到者胜”一致
+void addCompareSelect(const uint8_t* inBits, size_t period, size_t first, size_t steps,
+                      PathMetrics& pm, uint8_t* survivors) {
+    static const BranchTable table;
+    size_t pair = first % period;
     for (size_t t = 0; t < steps; ++t) {
-        uint8_t r0 = inBits[2 * t]     & 0x1;
-        uint8_t r1 = inBits[2 * t + 1] & 0x1;
+        uint8_t r0 = inBits[2 * pair]     & 0x1;
+        uint8_t r1 = inBits[2 * pair + 1] & 0x1;
+        if (++pair == period) pair = 0;
+
+        PathMetrics next;
+        uint8_t decisions = 0;
+        for (int ns = 0; ns < NUM_STATES; ++ns) {
+            const int base = (ns & 0x1) << 1;
+            int m0 = pm[base]     + (table.out0[ns][0] != r0) + (table.out1[ns][0] != r1); // Hamming 距离
+            int m1 = pm[base | 1] + (table.out0[ns][1] != r0) + (table.out1[ns][1] != r1);
+            if (m1 < m0) {
+                next[ns] = std::min(m1, INF);
+                decisions = static_cast<uint8_t>(decisions | (1u << ns));
+            } else {
+                next[ns] = std::min(m0, INF);
+            }
+        }
+        pm = next;
+        survivors[t] = decisions;
+    }
+}
 
-        for (int s = 0; s < NUM_STATES; ++s) {
-            pathMetric[t + 1][s] = INF;
+// 从时刻 steps 的 state 沿 survivors 回溯；时刻 t ∈ [lo, hi) 的输入比特写入 out[t - lo]。
+// 直接按时间顺序写入，省去反转
+void traceback(const uint8_t* survivors, size_t steps, int state, size_t lo, size_t hi, uint8_t* out) {
+    for (size_t t = steps; t > 0; --t) {
+        if (t - 1 >= lo && t - 1 < hi) {
+            out[t - 1 - lo] = static_cast<uint8_t>(state >> 1);
         }
+        int s2 = (survivors[t - 1] >> state) & 0x1;
+        state = ((state & 0x1) << 1) | s2;
+    }
+}
 
-        for (int s = 0; s < NUM_STATES; ++s) {
-            int pm = pathMetric[t][s];
-            if (pm >= INF) continue;
-
-            for (int u = 0; u < 2; ++u) {
-                const Branch& br = branches[s][u];
-                int dist = (br.out0 != r0) + (br.out1 != r1); // Hamming 距离
-                int cand = pm + dist;
-                uint8_t ns = br.nextState;
-
-                if (cand < pathMetric[t + 1][ns]) {
-                    pathMetric[t + 1][ns]    = cand;
-                    prevState[t + 1][ns]     = static_cast<uint8_t>(s);
-                    prevInputBit[t + 1][ns]  = static_cast<uint8_t>(u);
-                }
-            }
+int bestState(const PathMetrics& pm) {
+    return static_cast<int>(std::min_element(pm.begin(), pm.end()) - pm.begin());
+}
+
+// 咬尾：把码流看成环，前面接上最后 TAIL_BITING_WRAP 个时刻、后面接上最前面的同样多时刻，
+// 所有状态等概率起步，只输出中间一整圈的判决
+bool decodeTailBiting(const uint8_t* inBits, size_t steps,
+                      std::vector<uint8_t>& survivors,
+                      std::vector<uint8_t>& outBits,
+                      uint32_t* pathMetric) {
+    const size_t wrap  = TAIL_BITING_WRAP;
+    const size_t total = wrap + steps + wrap;
+    survivors.resize(total);
+
+    PathMetrics pm{};
+    addCompareSelect(inBits, steps, steps - wrap % steps, total, pm, survivors.data());
+
+    outBits.resize(steps);
+    traceback(survivors.data(), total, bestState(pm), wrap, wrap + steps, outBits.data());
+
+    // 绕回段的度量不属于这一圈：按判决重新咬尾编码，与接收比特比对得到纠正的编码比特数
+    if (pathMetric) {
+        const uint8_t* u = outBits.data();
+        uint8_t s1 = u[steps - 1];
+        uint8_t s2 = u[(2 * steps - 2) % steps];
+        uint32_t dist = 0;
+        for (size_t t = 0; t < steps; ++t) {
+            dist += static_cast<uint32_t>(((u[t] ^ s1 ^ s2) != (inBits[2 * t] & 0x1)) +
+                                          ((u[t] ^ s2) != (inBits[2 * t + 1] & 0x1)));
+            s2 = s1;
+            s1 = u[t];
         }
+        *pathMetric = dist;
+    }
+    return true;
+}
+
+} // namespace
+
+bool convDecode(const std::vector<uint8_t>& inBits, std::vector<uint8_t>& outBits) {
+    std::vector<uint8_t> survivors;
+    return convDecode(inBits.data(), inBits.size(), survivors, outBits);
+}
+
+// 状态 ns = (u << 1) | s1 的两个前驱为 (s1 << 1) | s2，s2 ∈ {0,1}，输入比特 u = ns >> 1。
+// 因此每个状态只需记录 1 bit 判决 s2，回溯时即可还原前驱状态和输入比特
+bool convDecode(const uint8_t* inBits, size_t count,
+                std::vector<uint8_t>& survivors,
+                std::vector<uint8_t>& outBits,
+                ConvTermination termination,
+                uint32_t* pathMetric) {
+    outBits.clear();
+    if (count == 0 || (count % 2) != 0) {
+        return false;
+    }
+
+    const size_t steps = count / 2; // 每两比特对应一个时刻
+    if (termination == ConvTermination::TailBiting) {
+        return decodeTailBiting(inBits, steps, survivors, outBits, pathMetric);
     }
 
-    // 编码时用尾比特把状态冲洗回 0，所以终点最好选 state=0
-    int bestState = 0;
-    int bestMetric = pathMetric[steps][0];
-    if (bestMetric >= INF) {
+    const bool terminated = (termination == ConvTermination::Zero);
+    if (terminated && steps <= static_cast<size_t>(K - 1)) {
         return false;
     }
 
-    // 回溯
-    std::vector<uint8_t> allBits;
-    allBits.reserve(steps);
-    int curState = bestState;
-    for (size_t t = steps; t > 0; --t) {
-        uint8_t u = prevInputBit[t][curState];
-        allBits.push_back(u);
-        curState = prevState[t][curState];
+    // 零起点：初始状态为 0；咬尾码流的前缀起点未知，所有状态等概率
+    PathMetrics pm;
+    for (int s = 0; s < NUM_STATES; ++s) {
+        pm[s] = (s == 0 || termination == ConvTermination::TailBitingPrefix) ? 0 : INF;
     }
-    std::reverse(allBits.begin(), allBits.end());
 
-    // 去尾比特 K-1
-    if (allBits.size() <= (K - 1)) {
+    survivors.resize(steps);
+    addCompareSelect(inBits, steps, 0, steps, pm, survivors.data());
+
+    // 编码时用尾比特把状态冲洗回 0，所以终点选 state=0；前缀解码时取度量最小的状态
+    const int endState = terminated ? 0 : bestState(pm);
+    if (pm[endState] >= INF) {
         return false;
     }
-    allBits.resize(allBits.size() - (K - 1));
+    if (pathMetric) {
+        *pathMetric = static_cast<uint32_t>(pm[endState]);
+    }
 
-    outBits = std::move(allBits);
+    // 尾比特 K-1 个不输出
+    const size_t infoBits = terminated ? steps - (K - 1) : steps;
+    outBits.resize(infoBits);
+    traceback(survivors.data(), steps, endState, 0, infoBits, outBits.data());
     return true;
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 // 把字节展开为 bit 向量（高位在前，元素为 0/1）
@@ -13,7 +14,31 @@ void bitsToBytes(const std::vector<uint8_t>& bits, std::vector<uint8_t>& bytes);
 // outBits: 0/1，长度约为 2 * (inBits.size() + (K-1))
 void convEncode(const std::vector<uint8_t>& inBits, std::vector<uint8_t>& outBits);
 
+// 咬尾卷积编码：编码器初始状态取最后 K-1 个信息比特，结束时状态回到起点，不加尾比特
+// outBits: 长度恰为 2 * inBits.size()
+void convEncodeTailBiting(const std::vector<uint8_t>& inBits, std::vector<uint8_t>& outBits);
+
+// 码流的起止约束
+enum class ConvTermination {
+    Zero,              // 从状态 0 开始，K-1 个尾比特把状态冲洗回 0（convEncode）
+    Prefix,            // 从状态 0 开始，只有码流前缀：终点自由
+    TailBiting,        // 咬尾（convEncodeTailBiting）：绕回 Viterbi，起点 = 终点
+    TailBitingPrefix,  // 咬尾码流的前缀：起点未知，终点自由
+};
+
 // 卷积 Viterbi 解码（硬判决定距，已知编码时添加了 K-1 个尾比特让状态回到 0）
 // inBits: 0/1，长度为偶数
 // outBits: 0/1，输出原始信息比特
-bool convDecode(const std::vector<uint8_t>& inBits, std::vector<uint8_t>& outBits);
\ No newline at end of file
+bool convDecode(const std::vector<uint8_t>& inBits, std::vector<uint8_t>& outBits);
+
+// 同上，幸存路径存放在调用方提供的 survivors 中（每时刻 1 字节，4 个状态各 1 bit 判决），
+// survivors / outBits 只在容量不足时增长，重复调用稳态下不分配内存
+// Prefix / TailBitingPrefix 用于只解码码流前缀：从度量最小的状态回溯，
+// 输出全部 count/2 个比特（不去尾比特，末尾若干比特可靠性较低）
+// TailBiting 输出 count/2 个比特，码流两端各绕回一段，比零尾多算约 48 个时刻
+// pathMetric 非空时输出回溯起点的路径度量（与接收比特的 Hamming 距离，即纠正的编码比特数）
+bool convDecode(const uint8_t* inBits, size_t count,
+                std::vector<uint8_t>& survivors,
+                std::vector<uint8_t>& outBits,
+                ConvTermination termination = ConvTermination::Zero,
+                uint32_t* pathMetric = nullptr);
@@ -32,7 +32,22 @@ bool parseFrame(const std::vector<uint8_t>& frame,
                 uint8_t& seqOut) {
     payloadOut.clear();
 
-    if (frame.size() < 5 + 2) {
+    const uint8_t* payload = nullptr;
+    size_t len = 0;
+    if (!parseFrame(frame.data(), frame.size(), payload, len, seqOut)) {
+        return false;
+    }
+    payloadOut.assign(payload, payload + len);
+    return true;
+}
+
+bool parseFrame(const uint8_t* frame, size_t size,
+                const uint8_t*& payloadOut, size_t& payloadLen,
+                uint8_t& seqOut) {
+    payloadOut = nullptr;
+    payloadLen = 0;
+
+    if (size < 5 + 2) {
         std::cerr << "Frame too short\n";
         return false;
     }
@@ -48,7 +63,7 @@ bool parseFrame(const std::vector<uint8_t>& frame,
 
     size_t headerSize   = 5;
     size_t expectedSize = headerSize + len + 2;
-    if (frame.size() < expectedSize) {
+    if (size < expectedSize) {
         std::cerr << "Frame length mismatch\n";
         return false;
     }
@@ -56,13 +71,32 @@ bool parseFrame(const std::vector<uint8_t>& frame,
     size_t crcPos = expectedSize - 2;
     uint16_t crcRecv = static_cast<uint16_t>(frame[crcPos] << 8)
                      | static_cast<uint16_t>(frame[crcPos + 1]);
-    uint16_t crcCalc = crc16_ccitt(frame.data(), expectedSize - 2);
+    uint16_t crcCalc = crc16_ccitt(frame, expectedSize - 2);
 
     if (crcRecv != crcCalc) {
         std::cerr << "Frame CRC mismatch\n";
         return false;
     }
 
-    payloadOut.assign(frame.begin() + headerSize, frame.begin() + headerSize + len);
+    payloadOut = frame + headerSize;
+    payloadLen = len;
+    return true;
+}
+
+void putFrameExtHeader(std::vector<uint8_t>& out, const FrameExtHeader& ext) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(ext.offset >> (8 * i)));
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(ext.total >> (8 * i)));
+}
+
+bool getFrameExtHeader(const uint8_t* payload, size_t size, FrameExtHeader& ext) {
+    if (size < FRAME_EXT_BYTES) {
+        return false;
+    }
+    ext.offset = 0;
+    ext.total  = 0;
+    for (int i = 3; i >= 0; --i) {
+        ext.offset = (ext.offset << 8) | payload[i];
+        ext.total  = (ext.total << 8) | payload[4 + i];
+    }
     return true;
-}
\ No newline at end of file
+}
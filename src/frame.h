@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 // 帧格式：
@@ -7,12 +8,38 @@
 // [1] marker2 = 0x5A
 // [2] len_lo
 // [3] len_hi   -> uint16_t payloadLen
-// [4] seq      -> 帧号
+// [4] seq      -> 帧号（低 6 位）+ 标志位（bit7/bit6）
 // [5..] payload bytes
 // [最后2字节] CRC16(frame[0..len+4])  不含 CRC 自己
 
+// seq 字节的标志位
+constexpr uint8_t FRAME_FLAG_COMPRESSED = 0x80;   // payload（扩展头之后的部分）为 lzCompress 压缩流
+constexpr uint8_t FRAME_FLAG_EXTENDED   = 0x40;   // payload 以扩展头开始：多帧流中的一帧
+constexpr uint8_t FRAME_SEQ_MASK        = 0x3F;
+
+// 多帧流的扩展头，位于 payload 最前面（小端，不参与压缩，受帧 CRC 保护）：
+//   u32 offset  本帧数据在整个流中的字节偏移（解压后）
+//   u32 total   整个流的字节数
+// 每帧各自终止 FEC、各自补齐到整符号，帧与帧首尾相接，任一帧都可以单独解调
+constexpr size_t FRAME_EXT_BYTES = 8;
+
+struct FrameExtHeader {
+    uint32_t offset = 0;
+    uint32_t total  = 0;
+};
+
+void putFrameExtHeader(std::vector<uint8_t>& out, const FrameExtHeader& ext);
+
+// payload 不足 FRAME_EXT_BYTES 时返回 false
+bool getFrameExtHeader(const uint8_t* payload, size_t size, FrameExtHeader& ext);
+
 std::vector<uint8_t> buildFrame(const std::vector<uint8_t>& payload, uint8_t seq);
 
 bool parseFrame(const std::vector<uint8_t>& frame,
                 std::vector<uint8_t>& payloadOut,
+                uint8_t& seqOut);
+
+// 同上，但不拷贝 payload：payloadOut 指向 frame 内部，frame 有效期间可用
+bool parseFrame(const uint8_t* frame, size_t size,
+                const uint8_t*& payloadOut, size_t& payloadLen,
                 uint8_t& seqOut);
\ No newline at end of file
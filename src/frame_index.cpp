@@ -0,0 +1,119 @@
+// src/frame_index.cpp
+#include "frame_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr char   INDEX_MAGIC[8]     = {'F', 'S', 'K', 'I', 'D', 'X', '0', '1'};
+constexpr size_t INDEX_HEADER_BYTES = 4 + 4 + 4 + 8 + 4;
+constexpr size_t INDEX_RECORD_BYTES = 8 + 4 + 8 + 4;
+
+void putLE(std::string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+}
+
+uint64_t getLE(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+} // namespace
+
+bool writeFrameIndex(const std::string& path, const FrameIndex& index) {
+    std::string out(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    out.reserve(sizeof(INDEX_MAGIC) + INDEX_HEADER_BYTES + index.frames.size() * INDEX_RECORD_BYTES);
+    putLE(out, index.sampleRate, 4);
+    putLE(out, index.symbolSamples, 4);
+    putLE(out, static_cast<uint32_t>(index.rateModeId), 4);
+    putLE(out, index.totalBytes, 8);
+    putLE(out, index.frames.size(), 4);
+    for (const FrameIndexEntry& e : index.frames) {
+        putLE(out, e.byteOffset, 8);
+        putLE(out, e.byteLen, 4);
+        putLE(out, e.sampleOffset, 8);
+        putLE(out, e.symbols, 4);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open index for writing: " << path << "\n";
+        return false;
+    }
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    file.flush();
+    if (!file) {
+        std::cerr << "Failed to write index: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool readFrameIndex(const std::string& path, FrameIndex& index) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open index: " << path << "\n";
+        return false;
+    }
+
+    char magic[sizeof(INDEX_MAGIC)] = {};
+    uint8_t hdr[INDEX_HEADER_BYTES];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0 ||
+        !file.read(reinterpret_cast<char*>(hdr), sizeof(hdr))) {
+        std::cerr << "Not a frame index file: " << path << "\n";
+        return false;
+    }
+    index.sampleRate    = static_cast<uint32_t>(getLE(hdr, 4));
+    index.symbolSamples = static_cast<uint32_t>(getLE(hdr + 4, 4));
+    index.rateModeId    = static_cast<int32_t>(static_cast<uint32_t>(getLE(hdr + 8, 4)));
+    index.totalBytes    = getLE(hdr + 12, 8);
+    const size_t count  = static_cast<size_t>(getLE(hdr + 20, 4));
+
+    index.frames.clear();
+    index.frames.reserve(std::min<size_t>(count, 1 << 20));
+    uint64_t expectOffset = 0;
+    uint8_t rec[INDEX_RECORD_BYTES];
+    for (size_t i = 0; i < count; ++i) {
+        if (!file.read(reinterpret_cast<char*>(rec), sizeof(rec))) {
+            std::cerr << "Truncated frame index: " << path << "\n";
+            return false;
+        }
+        FrameIndexEntry e;
+        e.byteOffset   = getLE(rec, 8);
+        e.byteLen      = static_cast<uint32_t>(getLE(rec + 8, 4));
+        e.sampleOffset = getLE(rec + 12, 8);
+        e.symbols      = static_cast<uint32_t>(getLE(rec + 20, 4));
+        // 帧必须按字节偏移首尾相接，framesCovering 依赖这一点做二分查找
+        if (e.byteOffset != expectOffset) {
+            std::cerr << "Corrupt frame index (frame " << i << " out of order): " << path << "\n";
+            return false;
+        }
+        expectOffset += e.byteLen;
+        index.frames.push_back(e);
+    }
+    if (expectOffset != index.totalBytes) {
+        std::cerr << "Corrupt frame index (frames do not cover the stream): " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+void framesCovering(const FrameIndex& index, uint64_t begin, uint64_t end,
+                    size_t& first, size_t& last) {
+    const auto& f = index.frames;
+    // 第一个结束位置 > begin 的帧，到第一个起始位置 >= end 的帧为止
+    auto lo = std::upper_bound(f.begin(), f.end(), begin,
+        [](uint64_t v, const FrameIndexEntry& e) { return v < e.byteOffset + e.byteLen; });
+    auto hi = std::lower_bound(lo, f.end(), end,
+        [](const FrameIndexEntry& e, uint64_t v) { return e.byteOffset < v; });
+    first = static_cast<size_t>(lo - f.begin());
+    last  = static_cast<size_t>(hi - f.begin());
+}
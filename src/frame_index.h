@@ -0,0 +1,36 @@
+// src/frame_index.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 多帧流的边车索引：payload 字节区间 -> 帧在 data chunk 中的样本位置。
+// 编码时直接写出（encode --index），或对已有录音扫描一遍建立（index 模式，只解调每帧开头几个符号）。
+// 解码 --range 时按索引直接定位到覆盖该区间的帧，耗时只与区间长度有关，与整个文件大小无关
+
+struct FrameIndexEntry {
+    uint64_t byteOffset   = 0;   // 本帧数据在流中的字节偏移（解压后）
+    uint32_t byteLen      = 0;   // 本帧数据的字节数（解压后）
+    uint64_t sampleOffset = 0;   // 本帧第一个符号在 data chunk 中的样本序号
+    uint32_t symbols      = 0;   // 本帧占用的数据符号数
+};
+
+struct FrameIndex {
+    uint32_t sampleRate    = 0;    // 编码采样率（样本序号以此为单位）
+    uint32_t symbolSamples = 0;    // 数据符号长度 N
+    int32_t  rateModeId    = -1;   // 自适应模式的速率模式，-1 = 固定参数
+    uint64_t totalBytes    = 0;
+    std::vector<FrameIndexEntry> frames;
+};
+
+// 文件格式（全部小端）：8 字节 "FSKIDX01"，u32 sample_rate，u32 symbol_samples，i32 rate_mode，
+// u64 total_bytes，u32 count，之后 count 条 24 字节记录：
+//   u64 byte_offset, u32 byte_len, u64 sample_offset, u32 symbols
+// 失败时打印原因并返回 false
+bool writeFrameIndex(const std::string& path, const FrameIndex& index);
+bool readFrameIndex(const std::string& path, FrameIndex& index);
+
+// 帧按字节偏移连续排列时，与 [begin, end) 相交的帧下标区间 [first, last)
+void framesCovering(const FrameIndex& index, uint64_t begin, uint64_t end,
+                    size_t& first, size_t& last);
@@ -0,0 +1,86 @@
+// src/kernels.cpp
+#include "kernels.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(AUDIO_CODEC_X86_KERNELS) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+#ifdef AUDIO_CODEC_X86_KERNELS
+#ifdef _MSC_VER
+CpuFeatures detectX86() {
+    CpuFeatures f;
+    int r[4];
+    __cpuid(r, 0);
+    const int maxLeaf = r[0];
+    __cpuid(r, 1);
+    const bool osxsave = (r[2] & (1 << 27)) != 0;
+    const bool fma     = (r[2] & (1 << 12)) != 0;
+    if (!osxsave || maxLeaf < 7) return f;
+
+    // XCR0：bit1/2 = XMM/YMM，bit5..7 = opmask / ZMM 高 256 位 / ZMM16..31
+    const unsigned long long xcr0 = _xgetbv(0);
+    const bool ymmOs = (xcr0 & 0x6) == 0x6;
+    const bool zmmOs = (xcr0 & 0xE6) == 0xE6;
+    __cpuidex(r, 7, 0);
+    f.avx2    = ymmOs && fma && (r[1] & (1 << 5)) != 0;
+    f.avx512f = zmmOs && f.avx2 && (r[1] & (1 << 16)) != 0;
+    return f;
+}
+#else
+CpuFeatures detectX86() {
+    // libgcc / compiler-rt 的实现已经检查了 XCR0（OS 是否保存 YMM/ZMM 状态）
+    __builtin_cpu_init();
+    CpuFeatures f;
+    f.avx2    = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    f.avx512f = f.avx2 && __builtin_cpu_supports("avx512f");
+    return f;
+}
+#endif
+#endif
+
+const KernelTable& selectKernels() {
+    const CpuFeatures cpu = detectCpuFeatures();
+
+    // 可选上限：0 = baseline，1 = avx2，2 = avx512
+    int cap = 2;
+    if (const char* env = std::getenv("AUDIO_CODEC_ISA")) {
+        if (std::strcmp(env, "baseline") == 0) {
+            cap = 0;
+        } else if (std::strcmp(env, "avx2") == 0) {
+            cap = 1;
+        } else if (std::strcmp(env, "avx512") != 0) {
+            std::cerr << "Warning: unknown AUDIO_CODEC_ISA '" << env
+                      << "', expected baseline|avx2|avx512\n";
+        }
+    }
+
+#ifdef AUDIO_CODEC_X86_KERNELS
+    if (cap >= 2 && cpu.avx512f) return kernel_isa::avx512;
+    if (cap >= 1 && cpu.avx2) return kernel_isa::avx2;
+#else
+    (void)cpu;
+#endif
+    return kernel_isa::baseline;
+}
+
+} // namespace
+
+CpuFeatures detectCpuFeatures() {
+#ifdef AUDIO_CODEC_X86_KERNELS
+    return detectX86();
+#else
+    return CpuFeatures{};
+#endif
+}
+
+const KernelTable& kernels() {
+    static const KernelTable& table = selectKernels();
+    return table;
+}
@@ -0,0 +1,43 @@
+// src/kernels.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 热点内核的多 ISA 版本，同一个二进制里同时编进 baseline / AVX2 / AVX-512 三份，
+// 启动后第一次调用 kernels() 时按 CPUID 选出当前机器支持的最快一份。
+// 带 ISA 编译选项的 kernels_*.cpp 里不使用标准库模板 / inline 函数：它们在每个 TU 各实例化一份，
+// 链接器可能保留带 AVX 指令的那份给基线代码调用
+struct KernelTable {
+    const char* name;
+
+    // Goertzel 滤波器组：一次遍历 data[0..N)，powers[j] 输出系数 coeffs[j]（2cos ω）对应 bin 的能量
+    void (*goertzelPowers)(const float* data, uint32_t N,
+                           const float* coeffs, size_t M, float* powers);
+
+    // FIR 点积：x 与 h 各 n 个 float
+    float (*dot)(const float* x, const float* h, int n);
+
+    // Goertzel 滤波器组每个 bin 每个样本的实测代价，折算成标量 flop（向量越宽越小）；
+    // 多发送端共享频谱时据此在 Goertzel 与 FFT 之间选择（见 channelizer.h）
+    double goertzelFlopsPerBin;
+};
+
+// 各 ISA 版本（kernels_*.cpp），只有编译器和目标架构支持时才存在
+namespace kernel_isa {
+extern const KernelTable baseline;
+#ifdef AUDIO_CODEC_X86_KERNELS
+extern const KernelTable avx2;     // AVX2 + FMA
+extern const KernelTable avx512;   // AVX-512F
+#endif
+} // namespace kernel_isa
+
+struct CpuFeatures {
+    bool avx2    = false;   // AVX2 + FMA，且 OS 保存 YMM 状态
+    bool avx512f = false;   // AVX-512F，且 OS 保存 ZMM 状态
+};
+
+CpuFeatures detectCpuFeatures();
+
+// 当前选用的内核表（线程安全的一次性初始化，之后只读）
+// 环境变量 AUDIO_CODEC_ISA=baseline|avx2|avx512 可把选择压低到指定级别（对比 / 排查用）
+const KernelTable& kernels();
@@ -0,0 +1,91 @@
+// src/kernels_avx2.cpp
+// AVX2 + FMA 版本：本文件单独以 -mavx2 -mfma（MSVC: /arch:AVX2）编译，只在 CPUID 确认支持后调用
+#include "kernels.h"
+
+#include <immintrin.h>
+
+namespace {
+
+constexpr int LANES = 8;
+
+// V 个 ymm（V * 8 个 bin）的 Goertzel 状态全部放在寄存器里，每个样本只广播一次。
+// 不足一整块的 bin 用系数 0 补齐，补出来的通道结果直接丢弃
+template <int V>
+void goertzelBlock(const float* data, uint32_t N, const float* coeffs, size_t m, float* powers) {
+    alignas(32) float c[V * LANES] = {};
+    for (size_t j = 0; j < m; ++j) c[j] = coeffs[j];
+
+    __m256 cv[V];
+    __m256 s1[V];
+    __m256 s2[V];
+    for (int v = 0; v < V; ++v) {
+        cv[v] = _mm256_load_ps(c + v * LANES);
+        s1[v] = _mm256_setzero_ps();
+        s2[v] = _mm256_setzero_ps();
+    }
+
+    for (uint32_t i = 0; i < N; ++i) {
+        const __m256 x = _mm256_set1_ps(data[i]);
+        for (int v = 0; v < V; ++v) {
+            // s = x + c*s1 - s2
+            const __m256 s = _mm256_fmadd_ps(cv[v], s1[v], _mm256_sub_ps(x, s2[v]));
+            s2[v] = s1[v];
+            s1[v] = s;
+        }
+    }
+
+    alignas(32) float a[V * LANES];
+    alignas(32) float b[V * LANES];
+    for (int v = 0; v < V; ++v) {
+        _mm256_store_ps(a + v * LANES, s1[v]);
+        _mm256_store_ps(b + v * LANES, s2[v]);
+    }
+    for (size_t j = 0; j < m; ++j) {
+        powers[j] = b[j] * b[j] + a[j] * a[j] - c[j] * a[j] * b[j];
+    }
+}
+
+void goertzelPowersAvx2(const float* data, uint32_t N,
+                        const float* coeffs, size_t M, float* powers) {
+    // 一块最多 4 个 ymm（32 个 bin）：状态 + 系数共 12 个寄存器，不会溢出到栈
+    size_t base = 0;
+    while (base < M) {
+        const size_t m = (M - base < 4 * LANES) ? M - base : 4 * LANES;
+        switch ((m + LANES - 1) / LANES) {
+            case 1:  goertzelBlock<1>(data, N, coeffs + base, m, powers + base); break;
+            case 2:  goertzelBlock<2>(data, N, coeffs + base, m, powers + base); break;
+            case 3:  goertzelBlock<3>(data, N, coeffs + base, m, powers + base); break;
+            default: goertzelBlock<4>(data, N, coeffs + base, m, powers + base); break;
+        }
+        base += m;
+    }
+}
+
+float dotAvx2(const float* x, const float* h, int n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i),     _mm256_loadu_ps(h + i),     acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(h + i + 8), acc1);
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(h + i), acc0);
+        i += 8;
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    float sum = _mm_cvtss_f32(s);
+    for (; i < n; ++i) {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
+
+} // namespace
+
+namespace kernel_isa {
+const KernelTable avx2 = { "avx2", goertzelPowersAvx2, dotAvx2, 0.35 };
+} // namespace kernel_isa
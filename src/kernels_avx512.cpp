@@ -0,0 +1,89 @@
+// src/kernels_avx512.cpp
+// AVX-512F 版本：本文件单独以 -mavx512f（MSVC: /arch:AVX512）编译，只在 CPUID 确认支持后调用
+#include "kernels.h"
+
+#include <immintrin.h>
+
+namespace {
+
+constexpr int LANES = 16;
+
+// 与 AVX2 版本相同的分块方式，每个 zmm 放 16 个 bin（默认 16-FSK 单子带正好一个寄存器）
+template <int V>
+void goertzelBlock(const float* data, uint32_t N, const float* coeffs, size_t m, float* powers) {
+    alignas(64) float c[V * LANES] = {};
+    for (size_t j = 0; j < m; ++j) c[j] = coeffs[j];
+
+    __m512 cv[V];
+    __m512 s1[V];
+    __m512 s2[V];
+    for (int v = 0; v < V; ++v) {
+        cv[v] = _mm512_load_ps(c + v * LANES);
+        s1[v] = _mm512_setzero_ps();
+        s2[v] = _mm512_setzero_ps();
+    }
+
+    for (uint32_t i = 0; i < N; ++i) {
+        const __m512 x = _mm512_set1_ps(data[i]);
+        for (int v = 0; v < V; ++v) {
+            const __m512 s = _mm512_fmadd_ps(cv[v], s1[v], _mm512_sub_ps(x, s2[v]));
+            s2[v] = s1[v];
+            s1[v] = s;
+        }
+    }
+
+    alignas(64) float a[V * LANES];
+    alignas(64) float b[V * LANES];
+    for (int v = 0; v < V; ++v) {
+        _mm512_store_ps(a + v * LANES, s1[v]);
+        _mm512_store_ps(b + v * LANES, s2[v]);
+    }
+    for (size_t j = 0; j < m; ++j) {
+        powers[j] = b[j] * b[j] + a[j] * a[j] - c[j] * a[j] * b[j];
+    }
+}
+
+void goertzelPowersAvx512(const float* data, uint32_t N,
+                          const float* coeffs, size_t M, float* powers) {
+    size_t base = 0;
+    while (base < M) {
+        const size_t m = (M - base < 4 * LANES) ? M - base : 4 * LANES;
+        switch ((m + LANES - 1) / LANES) {
+            case 1:  goertzelBlock<1>(data, N, coeffs + base, m, powers + base); break;
+            case 2:  goertzelBlock<2>(data, N, coeffs + base, m, powers + base); break;
+            case 3:  goertzelBlock<3>(data, N, coeffs + base, m, powers + base); break;
+            default: goertzelBlock<4>(data, N, coeffs + base, m, powers + base); break;
+        }
+        base += m;
+    }
+}
+
+float dotAvx512(const float* x, const float* h, int n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i),      _mm512_loadu_ps(h + i),      acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(h + i + 16), acc1);
+    }
+    // 剩余部分用掩码加载，不需要标量尾循环（默认 24 抽头正好是 16 + 掩码 8）
+    for (; i < n; i += 16) {
+        const int rem = (n - i < 16) ? n - i : 16;
+        const __mmask16 k = static_cast<__mmask16>((1u << rem) - 1u);
+        acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(k, x + i), _mm512_maskz_loadu_ps(k, h + i), acc0);
+    }
+    // 不用 _mm512_reduce_add_ps：GCC 12 的头文件实现会触发 -Wuninitialized
+    alignas(64) float lanes[LANES];
+    _mm512_store_ps(lanes, _mm512_add_ps(acc0, acc1));
+    float sum = 0.0f;
+    for (int j = 0; j < LANES; ++j) {
+        sum += lanes[j];
+    }
+    return sum;
+}
+
+} // namespace
+
+namespace kernel_isa {
+const KernelTable avx512 = { "avx512", goertzelPowersAvx512, dotAvx512, 0.3 };
+} // namespace kernel_isa
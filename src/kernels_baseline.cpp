@@ -0,0 +1,67 @@
+// src/kernels_baseline.cpp
+// 通用版本：只用目标架构的基线指令集（x86-64 上即 SSE2），不加额外编译选项
+#include "kernels.h"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define KERNELS_HAVE_SSE 1
+#endif
+
+namespace {
+
+// 每次处理 16 个 bin，状态放在局部数组里，编译器可以保持在寄存器中并按 SSE 向量化
+constexpr size_t BLOCK = 16;
+
+void goertzelPowersBaseline(const float* data, uint32_t N,
+                            const float* coeffs, size_t M, float* powers) {
+    for (size_t base = 0; base < M; base += BLOCK) {
+        const size_t m = std::min(BLOCK, M - base);
+        float c[BLOCK] = {};
+        float s1[BLOCK] = {};
+        float s2[BLOCK] = {};
+        std::copy(coeffs + base, coeffs + base + m, c);
+
+        for (uint32_t i = 0; i < N; ++i) {
+            const float x = data[i];
+            for (size_t j = 0; j < BLOCK; ++j) {
+                const float s = x + c[j] * s1[j] - s2[j];
+                s2[j] = s1[j];
+                s1[j] = s;
+            }
+        }
+
+        for (size_t j = 0; j < m; ++j) {
+            powers[base + j] = s2[j] * s2[j] + s1[j] * s1[j] - c[j] * s1[j] * s2[j];
+        }
+    }
+}
+
+float dotBaseline(const float* x, const float* h, int n) {
+    int i = 0;
+#ifdef KERNELS_HAVE_SSE
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i),     _mm_loadu_ps(h + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(h + i + 4)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc0);
+    float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    float sum = 0.0f;
+#endif
+    for (; i < n; ++i) {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
+
+} // namespace
+
+namespace kernel_isa {
+const KernelTable baseline = { "baseline", goertzelPowersBaseline, dotBaseline, 1.0 };
+} // namespace kernel_isa
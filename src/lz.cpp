@@ -0,0 +1,154 @@
+#include "lz.h"
+#include <cstring>
+
+namespace {
+
+constexpr int    MIN_MATCH     = 4;
+constexpr int    HASH_BITS     = 14;
+constexpr size_t MAX_OFFSET    = 0xFFFF;
+constexpr size_t LAST_LITERALS = 5;         // 末尾保留为 literal，保证匹配不越界
+constexpr uint64_t MAX_RAW_LEN = 1u << 28;  // 解压长度上限，防止损坏数据导致超大分配
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void putLength(std::vector<uint8_t>& out, size_t len) {
+    while (len >= 255) {
+        out.push_back(255);
+        len -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(len));
+}
+
+void putSequence(std::vector<uint8_t>& out,
+                 const uint8_t* lit, size_t litLen,
+                 size_t matchLen, size_t offset) {
+    const size_t ml = matchLen ? matchLen - MIN_MATCH : 0;
+    uint8_t token = static_cast<uint8_t>(((litLen < 15 ? litLen : 15) << 4) |
+                                         (ml < 15 ? ml : 15));
+    out.push_back(token);
+    if (litLen >= 15) putLength(out, litLen - 15);
+    out.insert(out.end(), lit, lit + litLen);
+
+    if (matchLen) {
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>((offset >> 8) & 0xFF));
+        if (ml >= 15) putLength(out, ml - 15);
+    }
+}
+
+bool getLength(const uint8_t*& p, const uint8_t* end, size_t& len) {
+    uint8_t b;
+    do {
+        if (p >= end) return false;
+        b = *p++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+} // namespace
+
+bool lzCompress(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+    out.clear();
+    const size_t n = in.size();
+    if (n == 0) return false;
+
+    // rawLen 头（varint）
+    uint64_t v = n;
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+
+    const uint8_t* src = in.data();
+    std::vector<int32_t> table(size_t(1) << HASH_BITS, -1);
+
+    size_t anchor = 0;   // 尚未输出的 literal 起点
+    size_t pos    = 0;
+    const size_t matchLimit = (n > LAST_LITERALS) ? n - LAST_LITERALS : 0;
+
+    while (pos + MIN_MATCH <= matchLimit) {
+        uint32_t seq = read32(src + pos);
+        uint32_t h = hash4(seq);
+        int32_t cand = table[h];
+        table[h] = static_cast<int32_t>(pos);
+
+        if (cand < 0 || pos - static_cast<size_t>(cand) > MAX_OFFSET ||
+            read32(src + cand) != seq) {
+            ++pos;
+            continue;
+        }
+
+        // 向后扩展匹配
+        size_t len = MIN_MATCH;
+        while (pos + len < matchLimit && src[cand + len] == src[pos + len]) {
+            ++len;
+        }
+
+        putSequence(out, src + anchor, pos - anchor, len, pos - static_cast<size_t>(cand));
+        if (out.size() >= n) return false;
+
+        // 把匹配内部的位置也登记进哈希表（隔一个），提升后续命中率
+        for (size_t k = pos + 1; k + MIN_MATCH <= pos + len && k + MIN_MATCH <= matchLimit; k += 2) {
+            table[hash4(read32(src + k))] = static_cast<int32_t>(k);
+        }
+        pos += len;
+        anchor = pos;
+    }
+
+    putSequence(out, src + anchor, n - anchor, 0, 0);
+    return out.size() < n;
+}
+
+bool lzDecompress(const uint8_t* in, size_t len, std::vector<uint8_t>& out) {
+    out.clear();
+    const uint8_t* p   = in;
+    const uint8_t* end = in + len;
+
+    uint64_t rawLen = 0;
+    for (int shift = 0; ; shift += 7) {
+        if (p >= end || shift > 56) return false;
+        uint8_t b = *p++;
+        rawLen |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+    if (rawLen == 0 || rawLen > MAX_RAW_LEN) return false;
+    out.reserve(static_cast<size_t>(rawLen));
+
+    while (p < end) {
+        uint8_t token = *p++;
+
+        size_t litLen = token >> 4;
+        if (litLen == 15 && !getLength(p, end, litLen)) return false;
+        if (litLen > static_cast<size_t>(end - p) || out.size() + litLen > rawLen) return false;
+        out.insert(out.end(), p, p + litLen);
+        p += litLen;
+
+        if (p == end) break;   // 最后一个序列只有 literal
+
+        if (end - p < 2) return false;
+        size_t offset = static_cast<size_t>(p[0]) | (static_cast<size_t>(p[1]) << 8);
+        p += 2;
+        size_t matchLen = token & 0x0F;
+        if (matchLen == 15 && !getLength(p, end, matchLen)) return false;
+        matchLen += MIN_MATCH;
+
+        if (offset == 0 || offset > out.size() || out.size() + matchLen > rawLen) return false;
+        // 逐字节复制：允许 offset < matchLen 的重叠匹配
+        size_t from = out.size() - offset;
+        for (size_t k = 0; k < matchLen; ++k) {
+            out.push_back(out[from + k]);
+        }
+    }
+
+    return out.size() == rawLen;
+}
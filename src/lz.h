@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 轻量 LZ77 压缩（LZ4 风格的 token/literal/offset 序列，单遍贪心哈希匹配）
+// 压缩流格式：
+//   [varint rawLen]
+//   重复：token (高 4 位 literal 长度, 低 4 位 match 长度-4，取 15 时后跟扩展字节)
+//         literals
+//         offset (2 字节小端, 1..65535)       —— 最后一个序列只有 literals，没有 offset
+// 扩展字节：依次累加，遇到 <255 的字节结束
+
+// 压缩 in；结果不比原始数据短（不可压缩）时返回 false，调用方应按原样存储
+bool lzCompress(const std::vector<uint8_t>& in, std::vector<uint8_t>& out);
+
+// 解压；数据损坏或越界时返回 false
+bool lzDecompress(const uint8_t* in, size_t len, std::vector<uint8_t>& out);
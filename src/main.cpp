@@ -1,8 +1,28 @@
 // src/main.cpp
 #include "encoder.h"
 #include "decoder.h"
+#include "batch.h"
+#include "rate_mode.h"
+#include "demod_q15.h"
+#include "scanner.h"
+#include "frame.h"
+#include "frame_index.h"
+#include "kernels.h"
+#include "telemetry.h"
+#include "async_io.h"
+#include "analyzer.h"
 
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <stdexcept>
 #include <cstdlib>
@@ -13,6 +33,32 @@ static void printUsage(const char* prog) {
               << "    " << prog << " encode -i <input.bin> -o <output.wav> [options]\n"
               << "  Decode (16-FSK DFT-bin + Frame + FEC):\n"
               << "    " << prog << " decode -i <input.wav> -o <output.bin> [options]\n"
+              << "  Batch encode / decode (shared LUT + thread pool):\n"
+              << "    " << prog << " encode-batch -i <manifest|dir> -o <outdir> [-j threads] [options]\n"
+              << "    " << prog << " decode-batch -i <manifest|dir> -o <outdir> [-j threads] [options]\n"
+              << "        # manifest: one \"<input> [output]\" per line; dir: all files (*.wav for decode)\n"
+              << "  Decode several transmitters sharing one recording in a single pass (shared spectrum):\n"
+              << "    " << prog << " decode-multi -i <input.wav> --streams <file> [--sr r] [--symdur s] [--start n] [--raw]\n"
+              << "        # streams file: one \"<output> [--bin* / --subbands / --substride / --sync / --tail-biting / --short]\"\n"
+              << "        # per line; all streams share --sr / --symdur / --start\n"
+              << "  Probe link quality (preamble SNR -> recommended rate mode):\n"
+              << "    " << prog << " probe -i <input.wav> [options]\n"
+              << "  Scan a long recording for bursts (energy gate + preamble search):\n"
+              << "    " << prog << " scan -i <input.wav> [-o <outdir>] [--gate-db d] [--min-rms r] [options]\n"
+              << "  Discover parameters from the preamble (N, bins, timing), optionally decode with them:\n"
+              << "    " << prog << " analyze -i <input.wav> [-o <output.bin>] [--max-symbol n] [decode options]\n"
+              << "        # prints the equivalent decode options; --sr/--symdur/--bin*/--sync are overridden\n"
+              << "  Compare Q15 fixed-point demod with float on synthetic symbols:\n"
+              << "    " << prog << " q15check [--symbols n] [--noise rms] [--amp a] [--seed s] [options]\n"
+              << "  Build a frame index for a multi-frame stream (one pass over the frame headers):\n"
+              << "    " << prog << " index -i <input.wav> [-o <index>] [decode options]\n"
+              << "        # default output <input.wav>.idx\n"
+              << "  Convert a binary telemetry file (decode --telemetry) to CSV:\n"
+              << "    " << prog << " telemetry -i <file.tlm> [-o <out.csv>]\n"
+              << "  Show detected CPU features and the selected kernel set:\n"
+              << "    " << prog << " cpuinfo\n"
+              << "        # AUDIO_CODEC_ISA=baseline|avx2|avx512 caps the selection\n"
+              << "        # AUDIO_CODEC_IO=thread disables io_uring file I/O\n"
               << "\nOptions (encode & decode):\n"
               << "    --sr <sampleRate>          (default 44100)\n"
               << "    --symdur <seconds>         (default 0.001, symbol duration)\n"
@@ -22,8 +68,171 @@ static void printUsage(const char* prog) {
               << "    --bin1  <k>                ...\n"
               << "    --bin15 <k>                (DFT bin index for symbol 15)\n"
               << "        # 实际频率 f_k = bin_k * sr / N, N = symdur * sr\n"
+              << "    --subbands <K>             (default 1, parallel 16-FSK sub-bands per symbol)\n"
+              << "        # 最高 bin max(bin*) + (K-1)*substride 须小于 N/2：默认 bins 下 K>1 需加长 --symdur\n"
+              << "        # （44.1 kHz：K=2 >= 0.001588，K=4 >= 0.003039），否则报错并给出最短可用值\n"
+              << "    --substride <bins>         (default 0 = bin span, bin offset between sub-bands)\n"
+              << "    --tail-biting              (tail-biting convolutional code, no FEC tail bits)\n"
+              << "    --short                    (short-message profile: --sync 16 --tail-biting)\n"
+              << "    --raw                      (headerless 16-bit mono PCM instead of WAV)\n"
+              << "    -i - / -o -                (read stdin / write stdout; status goes to stderr)\n"
               << "\nEncode-only options:\n"
-              << "    --amp <amplitude>          (default 12000, 16-bit PCM amplitude)\n";
+              << "    --amp <amplitude>          (default 12000, 16-bit PCM amplitude)\n"
+              << "    --compress                 (LZ-compress payload before framing; decoder detects it)\n"
+              << "    --rate-mode <id>           (adaptive: send mode header, data uses rate mode 0..4)\n"
+              << "    --frame-size <bytes>       (split payload into frames of this size; enables --range)\n"
+              << "    --index <file>             (write the frame index sidecar, needs --frame-size)\n"
+              << "\nDecode-only options:\n"
+              << "    --adaptive                 (read mode header after preamble and follow it)\n"
+              << "    --fixed-point              (integer-only Q15 Goertzel demodulation)\n"
+              << "    --telemetry <file>         (per-symbol margins, Viterbi metric, confusion matrix;\n"
+              << "                                *.csv = CSV, otherwise compact binary)\n"
+              << "    --range <a>:<b>            (decode only payload bytes [a, b) of a multi-frame stream;\n"
+              << "                                b may be omitted for \"to the end\")\n"
+              << "    --index <file>             (frame index for --range, default <input>.idx, else scan)\n"
+              << "    --pipeline                 (I/O, demod, FEC and framing on separate threads linked by\n"
+              << "                                SPSC queues; prints queue depth / stall counters)\n"
+              << "    --start <sample>           (preamble starts at this input sample; skips leading audio)\n"
+              << "\nRate modes (relative to --symdur / --bin*):\n";
+    for (int m = 0; m < RATE_MODE_COUNT; ++m) {
+        std::cout << "    " << m << ": " << rateMode(m).name << "\n";
+    }
+}
+
+// "-" 表示 stdin/stdout：关闭与 C stdio 的同步以加速大块读写；
+// Windows 下还要把标准流切换到二进制模式，否则 CRLF 转换会破坏 WAV/payload
+static void prepareStdio() {
+    std::ios::sync_with_stdio(false);
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+// 取选项的值，缺失时直接退出
+static const char* needValue(int& i, int argc, char** argv, const std::string& a) {
+    if (i + 1 >= argc) {
+        std::cerr << "Option " << a << " requires a value.\n";
+        std::exit(1);
+    }
+    return argv[++i];
+}
+
+// 短报文配置：前导从 64 个符号缩到 16 个（突发扫描对齐只用 8 个），FEC 改为咬尾码。
+// 20~50 字节的报文上固定开销从约 1/3 降到约 1/10；两端需同时指定
+constexpr int SHORT_PROFILE_SYNC_SYMBOLS = 16;
+
+// 解析编码/解码共用的参数；返回 false 表示不认识该选项
+template <typename Params>
+static bool parseCommonOption(const std::string& arg, int& i, int argc, char** argv, Params& params) {
+    if (arg == "--sr") {
+        params.sampleRate = static_cast<uint32_t>(std::stoul(needValue(i, argc, argv, arg)));
+    } else if (arg == "--symdur" || arg == "--bitdur") {
+        params.symbolDurationSec = std::stod(needValue(i, argc, argv, arg));
+    } else if (arg == "--sync") {
+        params.syncSymbols = std::stoi(needValue(i, argc, argv, arg));
+    } else if (arg == "--subbands") {
+        params.subbands = std::stoi(needValue(i, argc, argv, arg));
+    } else if (arg == "--substride") {
+        params.subbandStride = std::stoi(needValue(i, argc, argv, arg));
+    } else if (arg == "--tail-biting") {
+        params.tailBiting = true;
+    } else if (arg == "--short") {
+        params.syncSymbols = SHORT_PROFILE_SYNC_SYMBOLS;
+        params.tailBiting = true;
+    } else if (arg.rfind("--bin", 0) == 0) {
+        // 解析 --bin0 .. --bin15
+        // arg 形如 "--bin0" 或 "--bin10"
+        std::string idxStr = arg.substr(5); // 去掉前缀 "--bin"
+        int idx = std::stoi(idxStr);
+        if (idx < 0 || idx >= 16) {
+            std::cerr << "Bin index out of range (0..15): " << idx << "\n";
+            std::exit(1);
+        }
+        params.bins[idx] = std::stoi(needValue(i, argc, argv, arg));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parseEncodeOption(const std::string& arg, int& i, int argc, char** argv, EncodeParams& params) {
+    if (parseCommonOption(arg, i, argc, argv, params)) {
+        return true;
+    }
+    if (arg == "--amp") {
+        params.amplitude = static_cast<int16_t>(std::stoi(needValue(i, argc, argv, arg)));
+        return true;
+    }
+    if (arg == "--compress") {
+        params.compress = true;
+        return true;
+    }
+    if (arg == "--raw") {
+        params.rawPcm = true;
+        return true;
+    }
+    if (arg == "--rate-mode") {
+        params.rateModeId = std::stoi(needValue(i, argc, argv, arg));
+        return true;
+    }
+    if (arg == "--frame-size") {
+        params.frameBytes = static_cast<uint32_t>(std::stoul(needValue(i, argc, argv, arg)));
+        return true;
+    }
+    if (arg == "--index") {
+        params.indexPath = needValue(i, argc, argv, arg);
+        return true;
+    }
+    return false;
+}
+
+static bool parseDecodeOption(const std::string& arg, int& i, int argc, char** argv, DecodeParams& params) {
+    if (parseCommonOption(arg, i, argc, argv, params)) {
+        return true;
+    }
+    if (arg == "--adaptive") {
+        params.adaptive = true;
+        return true;
+    }
+    if (arg == "--fixed-point") {
+        params.fixedPoint = true;
+        return true;
+    }
+    if (arg == "--telemetry") {
+        params.telemetryPath = needValue(i, argc, argv, arg);
+        return true;
+    }
+    if (arg == "--raw") {
+        params.rawPcm = true;
+        return true;
+    }
+    if (arg == "--range") {
+        // a:b，b 省略时到流末尾
+        const std::string v = needValue(i, argc, argv, arg);
+        const size_t colon = v.find(':');
+        if (colon == std::string::npos || colon == 0) {
+            std::cerr << "--range expects <begin>:<end>\n";
+            std::exit(1);
+        }
+        params.range = true;
+        params.rangeBegin = std::stoull(v.substr(0, colon));
+        params.rangeEnd = colon + 1 < v.size() ? std::stoull(v.substr(colon + 1)) : UINT64_MAX;
+        return true;
+    }
+    if (arg == "--index") {
+        params.indexPath = needValue(i, argc, argv, arg);
+        return true;
+    }
+    if (arg == "--pipeline") {
+        params.pipeline = true;
+        return true;
+    }
+    if (arg == "--start") {
+        params.startSample = std::stoull(needValue(i, argc, argv, arg));
+        return true;
+    }
+    return false;
 }
 
 int main(int argc, char** argv) {
@@ -33,50 +242,34 @@ int main(int argc, char** argv) {
     }
 
     std::string mode = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        if (std::string(argv[i]) == "-") {
+            prepareStdio();
+            break;
+        }
+    }
+    const bool batch = (mode == "encode-batch" || mode == "decode-batch");
 
-    if (mode == "encode") {
-        std::string inputBin;
-        std::string outputWav;
-        EncodeParams params; // 带默认值
+    if (mode == "encode" || mode == "decode" || batch) {
+        const bool encode = (mode == "encode" || mode == "encode-batch");
+        std::string input;
+        std::string output;
+        unsigned threads = 0;
+        EncodeParams encParams; // 带默认值
+        DecodeParams decParams; // 带默认值
 
         for (int i = 2; i < argc; ++i) {
             std::string arg = argv[i];
-            auto needValue = [&](const std::string& a) {
-                if (i + 1 >= argc) {
-                    std::cerr << "Option " << a << " requires a value.\n";
-                    std::exit(1);
-                }
-            };
 
             if (arg == "-i") {
-                needValue(arg);
-                inputBin = argv[++i];
+                input = needValue(i, argc, argv, arg);
             } else if (arg == "-o") {
-                needValue(arg);
-                outputWav = argv[++i];
-            } else if (arg == "--sr") {
-                needValue(arg);
-                params.sampleRate = static_cast<uint32_t>(std::stoul(argv[++i]));
-            } else if (arg == "--symdur" || arg == "--bitdur") {
-                needValue(arg);
-                params.symbolDurationSec = std::stod(argv[++i]);
-            } else if (arg == "--sync") {
-                needValue(arg);
-                params.syncSymbols = std::stoi(argv[++i]);
-            } else if (arg == "--amp") {
-                needValue(arg);
-                params.amplitude = static_cast<int16_t>(std::stoi(argv[++i]));
-            } else if (arg.rfind("--bin", 0) == 0) {
-                // 解析 --bin0 .. --bin15
-                // arg 形如 "--bin0" 或 "--bin10"
-                needValue(arg);
-                std::string idxStr = arg.substr(5); // 去掉前缀 "--bin"
-                int idx = std::stoi(idxStr);
-                if (idx < 0 || idx >= 16) {
-                    std::cerr << "Bin index out of range (0..15): " << idx << "\n";
-                    return 1;
-                }
-                params.bins[idx] = std::stoi(argv[++i]);
+                output = needValue(i, argc, argv, arg);
+            } else if (arg == "-j" && batch) {
+                threads = static_cast<unsigned>(std::stoul(needValue(i, argc, argv, arg)));
+            } else if (encode ? parseEncodeOption(arg, i, argc, argv, encParams)
+                              : parseDecodeOption(arg, i, argc, argv, decParams)) {
+                // 已处理
             } else {
                 std::cerr << "Unknown option: " << arg << "\n";
                 printUsage(argv[0]);
@@ -84,78 +277,466 @@ int main(int argc, char** argv) {
             }
         }
 
-        if (inputBin.empty() || outputWav.empty()) {
-            std::cerr << "Both -i and -o are required for encode.\n";
+        if (input.empty() || output.empty()) {
+            std::cerr << "Both -i and -o are required for " << mode << ".\n";
             printUsage(argv[0]);
             return 1;
         }
 
-        if (!encodeFileToWav(inputBin, outputWav, params)) {
-            std::cerr << "Encode failed.\n";
-            return 1;
+        if (batch) {
+            if (!decParams.telemetryPath.empty()) {
+                std::cerr << "--telemetry is only supported for single-file decode.\n";
+                return 1;
+            }
+            if (decParams.range || !decParams.indexPath.empty() || !encParams.indexPath.empty()) {
+                std::cerr << "--range / --index are only supported for single-file encode / decode.\n";
+                return 1;
+            }
+            if (decParams.pipeline) {
+                std::cerr << "--pipeline is only supported for single-file decode (batch runs files in parallel).\n";
+                return 1;
+            }
+            std::vector<BatchJob> jobs;
+            if (!collectBatchJobs(input, output,
+                                  encode ? "" : ".wav",
+                                  encode ? ".wav" : ".bin", jobs)) {
+                return 1;
+            }
+            size_t failed = encode ? runEncodeBatch(jobs, encParams, threads)
+                                   : runDecodeBatch(jobs, decParams, threads);
+            return failed == 0 ? 0 : 1;
+        }
+
+        if (encode) {
+            if (!encodeFileToWav(input, output, encParams)) {
+                std::cerr << "Encode failed.\n";
+                return 1;
+            }
+        } else {
+            if (!decodeWavToFile(input, output, decParams)) {
+                std::cerr << "Decode failed.\n";
+                return 1;
+            }
         }
         return 0;
 
-    } else if (mode == "decode") {
-        std::string inputWav;
-        std::string outputBin;
-        DecodeParams params; // 带默认值
+    } else if (mode == "decode-multi") {
+        std::string input;
+        std::string streamsPath;
+        DecodeParams shared;
 
         for (int i = 2; i < argc; ++i) {
             std::string arg = argv[i];
-            auto needValue = [&](const std::string& a) {
-                if (i + 1 >= argc) {
-                    std::cerr << "Option " << a << " requires a value.\n";
-                    std::exit(1);
+            if (arg == "-i") {
+                input = needValue(i, argc, argv, arg);
+            } else if (arg == "--streams") {
+                streamsPath = needValue(i, argc, argv, arg);
+            } else if (!parseDecodeOption(arg, i, argc, argv, shared)) {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (input.empty() || streamsPath.empty()) {
+            std::cerr << "Both -i and --streams are required for decode-multi.\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        // 每行 "<output> [options]"：命令行上的参数作为各路的默认值，行内选项只覆盖这一路
+        std::ifstream ifs(streamsPath);
+        if (!ifs) {
+            std::cerr << "Failed to open streams file: " << streamsPath << "\n";
+            return 1;
+        }
+        std::vector<ChannelStream> streams;
+        std::string line;
+        for (int lineNo = 1; std::getline(ifs, line); ++lineNo) {
+            std::istringstream iss(line);
+            std::vector<std::string> tokens;
+            for (std::string t; iss >> t;) {
+                tokens.push_back(t);
+            }
+            if (tokens.empty() || tokens[0][0] == '#') continue;
+            if (tokens[0] == "-") {
+                std::cerr << streamsPath << ":" << lineNo << ": streams cannot be written to stdout.\n";
+                return 1;
+            }
+
+            ChannelStream stream;
+            stream.outputPath = tokens[0];
+            stream.params = shared;
+            std::vector<char*> args;
+            for (std::string& t : tokens) {
+                args.push_back(&t[0]);
+            }
+            const int n = static_cast<int>(args.size());
+            for (int i = 1; i < n; ++i) {
+                const std::string arg = args[i];
+                if (!parseCommonOption(arg, i, n, args.data(), stream.params)) {
+                    std::cerr << streamsPath << ":" << lineNo << ": unknown stream option: " << arg << "\n";
+                    return 1;
                 }
-            };
+            }
+            if (stream.params.sampleRate != shared.sampleRate ||
+                stream.params.symbolDurationSec != shared.symbolDurationSec) {
+                std::cerr << streamsPath << ":" << lineNo
+                          << ": --sr / --symdur are shared by all streams, give them on the command line.\n";
+                return 1;
+            }
+            streams.push_back(stream);
+        }
 
+        std::vector<ChannelResult> results;
+        ChannelStats stats;
+        if (!decodeChannelsToFiles(input, shared, streams, results, stats)) {
+            std::cerr << "Decode failed.\n";
+            return 1;
+        }
+
+        size_t failed = 0;
+        std::cout << "Multi-stream summary:\n";
+        for (size_t i = 0; i < streams.size(); ++i) {
+            if (!results[i].ok) ++failed;
+            std::cout << (results[i].ok ? "  OK    " : "  FAIL  ") << streams[i].outputPath;
+            if (results[i].ok) {
+                std::cout << "  (" << results[i].bytes << " bytes, " << results[i].dataSymbols << " symbols)";
+            }
+            std::cout << "\n";
+        }
+        std::cout << streams.size() << " streams, " << (streams.size() - failed) << " ok, " << failed
+                  << " failed; " << stats.windows << " windows, " << stats.spectra << " spectra ("
+                  << stats.fftSpectra << " by FFT), " << stats.binsComputed << " Goertzel bins for "
+                  << stats.binsUsed << " bins used\n";
+        return failed == 0 ? 0 : 1;
+
+    } else if (mode == "probe") {
+        std::string input;
+        DecodeParams params;
+
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
             if (arg == "-i") {
-                needValue(arg);
-                inputWav = argv[++i];
+                input = needValue(i, argc, argv, arg);
+            } else if (!parseDecodeOption(arg, i, argc, argv, params)) {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (input.empty()) {
+            std::cerr << "-i is required for probe.\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!params.telemetryPath.empty() || params.range || !params.indexPath.empty() || params.pipeline) {
+            std::cerr << "--telemetry / --range / --index / --pipeline are only supported for single-file decode.\n";
+            return 1;
+        }
+
+        SnrReport report;
+        if (!estimatePreambleSnr(input, params, report)) {
+            std::cerr << "Probe failed.\n";
+            return 1;
+        }
+        std::cout << "Preamble SNR over " << report.symbolsUsed << " symbols (dB):\n";
+        for (int j = 0; j < 16; ++j) {
+            std::cout << "  bin" << j << " (" << params.bins[j] << "): "
+                      << report.binSnrDb[j] << "\n";
+        }
+        std::cout << "Link SNR (worst bin): " << report.linkSnrDb << " dB\n"
+                  << "Recommended: --rate-mode " << report.recommendedMode
+                  << " (" << rateMode(report.recommendedMode).name << ")\n";
+        return 0;
+
+    } else if (mode == "scan") {
+        std::string input;
+        std::string outDir;
+        DecodeParams params;
+        ScanParams scan;
+
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-i") {
+                input = needValue(i, argc, argv, arg);
             } else if (arg == "-o") {
-                needValue(arg);
-                outputBin = argv[++i];
-            } else if (arg == "--sr") {
-                needValue(arg);
-                params.sampleRate = static_cast<uint32_t>(std::stoul(argv[++i]));
-            } else if (arg == "--symdur" || arg == "--bitdur") {
-                needValue(arg);
-                params.symbolDurationSec = std::stod(argv[++i]);
-            } else if (arg == "--sync") {
-                needValue(arg);
-                params.syncSymbols = std::stoi(argv[++i]);
-            } else if (arg.rfind("--bin", 0) == 0) {
-                needValue(arg);
-                std::string idxStr = arg.substr(5); // "--bin" 长度为5
-                int idx = std::stoi(idxStr);
-                if (idx < 0 || idx >= 16) {
-                    std::cerr << "Bin index out of range (0..15): " << idx << "\n";
-                    return 1;
-                }
-                params.bins[idx] = std::stoi(argv[++i]);
-            } else {
+                outDir = needValue(i, argc, argv, arg);
+            } else if (arg == "--gate-db") {
+                scan.gateDb = std::stod(needValue(i, argc, argv, arg));
+            } else if (arg == "--min-rms") {
+                scan.minRms = std::stod(needValue(i, argc, argv, arg));
+            } else if (!parseDecodeOption(arg, i, argc, argv, params)) {
                 std::cerr << "Unknown option: " << arg << "\n";
                 printUsage(argv[0]);
                 return 1;
             }
         }
+        if (input.empty()) {
+            std::cerr << "-i is required for scan.\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!params.telemetryPath.empty()) {
+            std::cerr << "--telemetry is only supported for single-file decode.\n";
+            return 1;
+        }
+        if (params.range || !params.indexPath.empty() || params.pipeline) {
+            std::cerr << "--range / --index / --pipeline are only supported for single-file decode.\n";
+            return 1;
+        }
+        if (!outDir.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(outDir, ec);
+            if (ec) {
+                std::cerr << "Failed to create output directory: " << outDir << "\n";
+                return 1;
+            }
+        }
+
+        params.verbose = false;
+        DecoderPlan plan;
+        if (!buildDecoderPlan(params, plan)) {
+            return 1;
+        }
+
+        bool writeFailed = false;
+        ScanStats stats;
+        auto onFrame = [&](const BurstFrame& f) {
+            std::cout << "Frame " << f.index << " at " << std::fixed << std::setprecision(6)
+                      << f.timeSec << " s (sample " << f.sampleOffset << "): "
+                      << f.payload.size << " bytes, seq " << (f.payload.seq & FRAME_SEQ_MASK);
+            if (!outDir.empty()) {
+                std::ostringstream name;
+                name << "burst_" << std::setw(4) << std::setfill('0') << f.index << ".bin";
+                const std::string path = (std::filesystem::path(outDir) / name.str()).string();
+                std::ofstream ofs(path, std::ios::binary);
+                ofs.write(reinterpret_cast<const char*>(f.payload.data),
+                          static_cast<std::streamsize>(f.payload.size));
+                if (!ofs) {
+                    std::cerr << "Failed to write " << path << "\n";
+                    writeFailed = true;
+                }
+                std::cout << " -> " << path;
+            }
+            std::cout << "\n";
+        };
+        if (!scanWavForBursts(input, plan, scan, onFrame, stats)) {
+            std::cerr << "Scan failed.\n";
+            return 1;
+        }
+        std::cout << std::defaultfloat
+                  << "Scanned " << stats.blocks << " blocks (" << stats.activeBlocks << " active, "
+                  << stats.regions << " regions), " << stats.candidates << " preamble candidates, "
+                  << stats.markerRejects << " header rejects, " << stats.decodeFailures
+                  << " decode failures, " << stats.frames << " frames\n";
+        return writeFailed ? 1 : 0;
+
+    } else if (mode == "analyze") {
+        std::string input;
+        std::string output;
+        DecodeParams params;
+        AnalyzeParams analyze;
 
-        if (inputWav.empty() || outputBin.empty()) {
-            std::cerr << "Both -i and -o are required for decode.\n";
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-i") {
+                input = needValue(i, argc, argv, arg);
+            } else if (arg == "-o") {
+                output = needValue(i, argc, argv, arg);
+            } else if (arg == "--max-symbol") {
+                analyze.maxSymbolSamples = static_cast<uint32_t>(std::stoul(needValue(i, argc, argv, arg)));
+            } else if (!parseDecodeOption(arg, i, argc, argv, params)) {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (input.empty()) {
+            std::cerr << "-i is required for analyze.\n";
             printUsage(argv[0]);
             return 1;
         }
+        if (input == "-" && !output.empty()) {
+            std::cerr << "analyze -o reads the input twice and needs a file, not stdin.\n";
+            return 1;
+        }
 
-        if (!decodeWavToFile(inputWav, outputBin, params)) {
+        SignalAnalysis r;
+        if (!analyzeSignal(input, params, analyze, r)) {
+            std::cerr << "Analyze failed.\n";
+            return 1;
+        }
+
+        // 解码结果写 stdout 时报告改写到 stderr
+        std::ostream& report = (output == "-") ? std::cerr : std::cout;
+        const double toneHz = static_cast<double>(r.sampleRate) / r.symbolSamples;
+        report << "Signal starts at sample " << r.startSample << " ("
+               << static_cast<double>(r.startSample) / r.sampleRate << " s), " << r.sampleRate << " Hz\n"
+               << "Symbol: N = " << r.symbolSamples << " samples (" << std::setprecision(12)
+               << r.symbolDurationSec << std::setprecision(6) << " s), period score " << r.periodScore << "\n"
+               << "Preamble: " << r.syncSymbols << " symbols, tone 0 = bin " << r.bins[0]
+               << " (" << r.bins[0] * toneHz << " Hz), tone 15 = bin " << r.bins[15]
+               << " (" << r.bins[15] * toneHz << " Hz)\n"
+               << "Sub-bands: " << r.subbands;
+        if (r.subbands > 1) {
+            report << " (stride " << r.subbandStride << " bins)";
+        }
+        report << "\nBins:";
+        for (int b : r.bins) {
+            report << " " << b;
+        }
+        report << " (" << r.tonesObserved << " of 16 tones seen in data"
+               << (r.tonesObserved < 16 ? ", rest assumed contiguous" : "") << ")\n";
+        if (r.headerFound) {
+            report << (r.crcChecked ? "First frame CRC OK: " : "Frame header OK (frame longer than analyzed audio): ")
+                   << r.payloadLen << " payload bytes, FEC "
+                   << (r.tailBiting ? "tail-biting" : "zero-tail")
+                   << (r.adaptive ? ", rate mode header" : "") << "\n";
+        } else {
+            report << "No valid frame header with these parameters\n";
+        }
+
+        // 等价的解码选项：采样率与符号时长总是给出，其余只列出与默认值不同的
+        const DecodeParams defaults;
+        report << "Decode options: --sr " << r.sampleRate << " --symdur " << std::setprecision(12)
+               << r.symbolDurationSec << std::setprecision(6);
+        if (r.syncSymbols != defaults.syncSymbols) report << " --sync " << r.syncSymbols;
+        for (int j = 0; j < 16; ++j) {
+            if (r.bins[j] != defaults.bins[j]) report << " --bin" << j << " " << r.bins[j];
+        }
+        if (r.subbands > 1) report << " --subbands " << r.subbands << " --substride " << r.subbandStride;
+        if (r.headerFound && r.tailBiting) report << " --tail-biting";
+        if (r.headerFound && r.adaptive) report << " --adaptive";
+        if (r.startSample != 0) report << " --start " << r.startSample;
+        report << "\n";
+
+        if (output.empty()) {
+            return r.headerFound ? 0 : 1;
+        }
+        if (!r.headerFound) {
+            std::cerr << "Not decoding: frame header check failed.\n";
+            return 1;
+        }
+        applyAnalysis(r, params);
+        if (!decodeWavToFile(input, output, params)) {
             std::cerr << "Decode failed.\n";
             return 1;
         }
         return 0;
 
+    } else if (mode == "q15check") {
+        DecodeParams params;
+        uint64_t numSymbols = 10000;
+        double noiseRms = 0.0;
+        double amplitude = 12000.0;
+        uint32_t seed = 1;
+
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--symbols") {
+                numSymbols = std::stoull(needValue(i, argc, argv, arg));
+            } else if (arg == "--noise") {
+                noiseRms = std::stod(needValue(i, argc, argv, arg));
+            } else if (arg == "--amp") {
+                amplitude = std::stod(needValue(i, argc, argv, arg));
+            } else if (arg == "--seed") {
+                seed = static_cast<uint32_t>(std::stoul(needValue(i, argc, argv, arg)));
+            } else if (!parseCommonOption(arg, i, argc, argv, params)) {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        Q15CheckResult result;
+        if (!compareQ15WithFloat(params, numSymbols, amplitude, noiseRms, seed, result)) {
+            std::cerr << "Q15 check failed.\n";
+            return 1;
+        }
+        std::cout << "Symbols: " << result.symbols
+                  << ", Q15/float mismatches: " << result.mismatches
+                  << ", float errors: " << result.floatErrors
+                  << ", Q15 errors: " << result.q15Errors << "\n";
+        return 0;
+
+    } else if (mode == "index") {
+        std::string input;
+        std::string output;
+        DecodeParams params;
+
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-i") {
+                input = needValue(i, argc, argv, arg);
+            } else if (arg == "-o") {
+                output = needValue(i, argc, argv, arg);
+            } else if (!parseDecodeOption(arg, i, argc, argv, params)) {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (input.empty()) {
+            std::cerr << "-i is required for index.\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (output.empty()) {
+            output = input + ".idx";
+        }
+
+        DecoderPlan plan;
+        FrameIndex index;
+        if (!buildDecoderPlan(params, plan) || !buildFrameIndex(input, plan, index) ||
+            !writeFrameIndex(output, index)) {
+            std::cerr << "Index failed.\n";
+            return 1;
+        }
+        std::cout << "Indexed " << index.frames.size() << " frames, " << index.totalBytes
+                  << " bytes -> " << output << "\n";
+        return 0;
+
+    } else if (mode == "telemetry") {
+        std::string input;
+        std::string output = "-";
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-i") {
+                input = needValue(i, argc, argv, arg);
+            } else if (arg == "-o") {
+                output = needValue(i, argc, argv, arg);
+            } else {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (input.empty()) {
+            std::cerr << "-i is required for telemetry.\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::ofstream file;
+        if (output != "-") {
+            file.open(output, std::ios::binary);
+            if (!file) {
+                std::cerr << "Failed to open output file: " << output << "\n";
+                return 1;
+            }
+        }
+        return telemetryToCsv(input, output == "-" ? std::cout : file) ? 0 : 1;
+
+    } else if (mode == "cpuinfo") {
+        const CpuFeatures cpu = detectCpuFeatures();
+        std::cout << "AVX2+FMA: " << (cpu.avx2 ? "yes" : "no")
+                  << ", AVX-512F: " << (cpu.avx512f ? "yes" : "no")
+                  << ", kernels: " << kernels().name
+                  << ", async I/O: " << asyncIoBackendName() << "\n";
+        return 0;
+
     } else {
         std::cerr << "Unknown mode: " << mode << "\n";
         printUsage(argv[0]);
         return 1;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,149 @@
+// src/rate_mode.cpp
+#include "rate_mode.h"
+#include "decoder.h"
+#include "demod.h"
+#include "sample_source.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+// minSnrDb 为经验阈值：在合成白噪声上用 3000 字节帧标定的“刚好能解出”的前导 SNR
+// （以基础符号时长、最差 bin 计）；模式 0 作为兜底不设门限
+const RateMode kRateModes[RATE_MODE_COUNT] = {
+    { 4, 2, true,  -100.0, "4x symbol, 4-FSK, FEC 1/2"  },
+    { 2, 2, true,     8.0, "2x symbol, 4-FSK, FEC 1/2"  },
+    { 2, 4, true,    10.5, "2x symbol, 16-FSK, FEC 1/2" },
+    { 1, 4, true,    12.5, "1x symbol, 16-FSK, FEC 1/2" },
+    { 1, 4, false,   13.5, "1x symbol, 16-FSK, uncoded" },
+};
+
+} // namespace
+
+const RateMode& rateMode(int id) {
+    if (id < 0 || id >= RATE_MODE_COUNT) {
+        throw std::runtime_error("Invalid rate mode id");
+    }
+    return kRateModes[id];
+}
+
+std::vector<uint8_t> modeHeaderSymbols(int modeId) {
+    const uint8_t id = static_cast<uint8_t>(modeId & 0xF);
+    const uint8_t byte = static_cast<uint8_t>((id << 4) | (~id & 0xF));
+
+    std::vector<uint8_t> symbols;
+    symbols.reserve(MODE_HEADER_SYMBOLS);
+    for (int r = 0; r < MODE_HEADER_REPEAT; ++r) {
+        for (int d = 0; d < MODE_HEADER_DIGITS; ++d) {
+            symbols.push_back(static_cast<uint8_t>((byte >> (6 - 2 * d)) & 0x3));
+        }
+    }
+    return symbols;
+}
+
+int parseModeHeader(const std::array<std::array<float, 4>, MODE_HEADER_DIGITS>& digitPowers) {
+    uint8_t byte = 0;
+    for (int d = 0; d < MODE_HEADER_DIGITS; ++d) {
+        const auto& p = digitPowers[d];
+        int best = static_cast<int>(std::max_element(p.begin(), p.end()) - p.begin());
+        byte = static_cast<uint8_t>((byte << 2) | best);
+    }
+
+    const int id = byte >> 4;
+    if ((byte & 0xF) != (~id & 0xF) || id >= RATE_MODE_COUNT) {
+        return -1;
+    }
+    return id;
+}
+
+bool estimatePreambleSnr(
+    const std::string& inputWavPath,
+    const DecodeParams& params,
+    SnrReport& report,
+    double marginDb
+) {
+    // 前导总是 16 个音中的音 0 / 音 15 交替，单子带分析即可
+    DecodeParams p = params;
+    p.subbands = 1;
+    p.toneBits = 4;
+
+    DemodPlan plan;
+    try {
+        plan = makeDemodPlan(p);
+    } catch (const std::exception& e) {
+        std::cerr << "Error in makeDemodPlan: " << e.what() << "\n";
+        return false;
+    }
+
+    WavReader reader;
+    if (!(p.rawPcm ? reader.openRawPcm16(inputWavPath, p.sampleRate) : reader.open(inputWavPath))) {
+        return false;
+    }
+    std::unique_ptr<SampleSource> source;
+    try {
+        source.reset(new SampleSource(reader, p.sampleRate));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return false;
+    }
+    // 与 decode 相同：前导从第 startSample 个样本开始（跳过开头的静音 / 干扰）
+    if (source->skip(p.startSample) != p.startSample) {
+        std::cerr << "Start sample " << p.startSample << " is beyond the end of the input.\n";
+        return false;
+    }
+
+    // 相邻 bin 落在 Hann 窗主瓣内，会收到发送音的泄漏，不计入噪声
+    auto inMainLobe = [&](int j, int active) {
+        return std::abs(p.bins[j] - p.bins[active]) <= 1;
+    };
+
+    DemodScratch scratch;
+    std::vector<float> frame(plan.N);
+    double signalSum = 0.0;
+    int signalCount = 0;
+    std::array<double, 16> noiseSum{};
+    std::array<int, 16> noiseCount{};
+
+    for (int i = 0; i < p.syncSymbols; ++i) {
+        if (source->read(frame.data(), frame.size()) != frame.size()) break;
+        preprocessFrame(frame.data(), plan);
+        goertzelBank(frame.data(), plan.N, plan.coeffs, scratch);
+
+        const int active = (i % 2 == 0) ? 0 : 15;
+        signalSum += scratch.powers[active];
+        ++signalCount;
+        for (int j = 0; j < 16; ++j) {
+            if (j == active || inMainLobe(j, active)) continue;
+            noiseSum[j] += scratch.powers[j];
+            ++noiseCount[j];
+        }
+    }
+
+    if (signalCount < 2) {
+        std::cerr << "Not enough preamble symbols for SNR estimate.\n";
+        return false;
+    }
+
+    const double signal = signalSum / signalCount;
+    report.symbolsUsed = signalCount;
+    report.linkSnrDb = 1e9;
+    for (int j = 0; j < 16; ++j) {
+        double noise = noiseCount[j] ? noiseSum[j] / noiseCount[j] : 0.0;
+        noise = std::max(noise, signal * 1e-12);   // 无噪声时上限 120 dB
+        report.binSnrDb[j] = 10.0 * std::log10(signal / noise);
+        report.linkSnrDb = std::min(report.linkSnrDb, report.binSnrDb[j]);
+    }
+
+    report.recommendedMode = 0;
+    for (int m = RATE_MODE_COUNT - 1; m >= 0; --m) {
+        if (report.linkSnrDb - marginDb >= kRateModes[m].minSnrDb) {
+            report.recommendedMode = m;
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+// src/rate_mode.h
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct DecodeParams;
+
+// 自适应速率模式：相对于基础参数（--symdur / --bin*）换算
+// 符号时长乘 symbolMultiplier 时 bins 同乘该倍数，实际频率 f = bin * Fs / N 不变
+struct RateMode {
+    int         symbolMultiplier;  // 符号时长倍数
+    int         toneBits;          // 字母表：每符号 bit 数，4 = 16-FSK，2 = 4-FSK
+    bool        fec;               // true = 卷积码 rate 1/2，false = 不编码
+    double      minSnrDb;          // 推荐该模式所需的最低前导 SNR（基础符号时长下测得，经验值）
+    const char* name;
+};
+
+// 按吞吐量从低到高排列；模式 3 与传统固定模式相同
+constexpr int RATE_MODE_COUNT = 5;
+const RateMode& rateMode(int id);
+
+// 模式头：紧跟前导，以 4 倍基础符号时长、4-FSK（单子带）发送
+// 内容为 1 字节：高 4 位 mode id，低 4 位为其反码；拆成 4 个 2-bit 符号，整段重复 3 次，
+// 接收端把同一位置 3 次重复的能量相加后再判决（软合并）
+constexpr int MODE_HEADER_SYMBOL_MULTIPLIER = 4;
+constexpr int MODE_HEADER_TONE_BITS         = 2;
+constexpr int MODE_HEADER_DIGITS            = 4;
+constexpr int MODE_HEADER_REPEAT            = 3;
+constexpr int MODE_HEADER_SYMBOLS           = MODE_HEADER_DIGITS * MODE_HEADER_REPEAT;
+
+// 按发送顺序给出模式头的 MODE_HEADER_SYMBOLS 个 4-FSK 符号（0..3）
+std::vector<uint8_t> modeHeaderSymbols(int modeId);
+
+// digitPowers[d][t]：第 d 个 2-bit 位置上 4 个音的累计能量；校验失败返回 -1
+int parseModeHeader(const std::array<std::array<float, 4>, MODE_HEADER_DIGITS>& digitPowers);
+
+// 基础参数换算为某个模式（或模式头）的参数；EncodeParams / DecodeParams 通用
+template <typename Params>
+Params scaleSymbolParams(const Params& base, int multiplier, int toneBits, bool fec) {
+    Params p = base;
+    p.symbolDurationSec = base.symbolDurationSec * multiplier;
+    for (auto& b : p.bins) {
+        b *= multiplier;
+    }
+    p.subbands      = 1;
+    p.subbandStride = 0;
+    p.toneBits      = toneBits;
+    p.fec           = fec;
+    return p;
+}
+
+template <typename Params>
+Params applyRateMode(const Params& base, int modeId) {
+    const RateMode& m = rateMode(modeId);
+    return scaleSymbolParams(base, m.symbolMultiplier, m.toneBits, m.fec);
+}
+
+template <typename Params>
+Params modeHeaderParams(const Params& base) {
+    return scaleSymbolParams(base, MODE_HEADER_SYMBOL_MULTIPLIER, MODE_HEADER_TONE_BITS, false);
+}
+
+// 前导 SNR 估计：前导只发送音 0 与音 15（交替），
+// 以它们的平均能量为信号，各 bin 在“未发送本音”的前导符号上的平均能量为噪声
+struct SnrReport {
+    std::array<double, 16> binSnrDb{};   // 每个 bin 的 SNR (dB)
+    double linkSnrDb       = 0.0;        // 最差 bin 的 SNR，决定符号错误率
+    int    recommendedMode = 0;          // 链路可承受的最快模式
+    int    symbolsUsed     = 0;
+};
+
+// 从 WAV 的前导估计 SNR 并推荐模式；marginDb 为额外安全余量
+bool estimatePreambleSnr(
+    const std::string& inputWavPath,
+    const DecodeParams& params,
+    SnrReport& report,
+    double marginDb = 3.0
+);
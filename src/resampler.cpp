@@ -0,0 +1,117 @@
+// src/resampler.cpp
+#include "resampler.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// 第一类零阶修正 Bessel 函数（级数展开），用于 Kaiser 窗
+double besselI0(double x) {
+    double sum  = 1.0;
+    double term = 1.0;
+    const double q = x * x / 4.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= q / (static_cast<double>(k) * k);
+        sum  += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+} // namespace
+
+PolyphaseResampler::PolyphaseResampler(uint32_t inRate, uint32_t outRate, int tapsPerPhase) {
+    if (inRate == 0 || outRate == 0 || tapsPerPhase <= 0) {
+        throw std::runtime_error("Invalid resampler configuration");
+    }
+    const uint32_t g = std::gcd(inRate, outRate);
+    L_    = outRate / g;
+    M_    = inRate / g;
+    taps_ = tapsPerPhase;
+    dot_  = kernels().dot;
+
+    // 原型低通：工作在上采样域（inRate * L），截止取两侧 Nyquist 较小者并留 10% 过渡带
+    const size_t len = static_cast<size_t>(L_) * static_cast<size_t>(taps_);
+    const double fc  = 0.5 / static_cast<double>(L_ > M_ ? L_ : M_) * 0.9;
+    const double c   = (static_cast<double>(len) - 1.0) / 2.0;
+    const double beta = 8.0;
+    const double i0Beta = besselI0(beta);
+    center_ = static_cast<uint64_t>(c);
+
+    std::vector<double> proto(len);
+    for (size_t i = 0; i < len; ++i) {
+        double t = static_cast<double>(i) - c;
+        double sinc = (t == 0.0) ? 1.0 : std::sin(2.0 * PI * fc * t) / (2.0 * PI * fc * t);
+        double r = t / c;
+        double win = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0Beta;
+        // 乘 L 补偿插零带来的增益损失
+        proto[i] = 2.0 * fc * sinc * win * L_;
+    }
+
+    // 拆成 L 组相位：相位 p 的第 k 个系数 h[p + k*L] 乘 x[n - k]，
+    // 反序存放后可与 x[n-T+1 .. n] 做连续点积
+    bank_.resize(len);
+    for (uint32_t p = 0; p < L_; ++p) {
+        for (int k = 0; k < taps_; ++k) {
+            bank_[static_cast<size_t>(p) * taps_ + (taps_ - 1 - k)] =
+                static_cast<float>(proto[p + static_cast<size_t>(k) * L_]);
+        }
+    }
+
+    buf_.assign(static_cast<size_t>(taps_ - 1), 0.0f);
+    bufStart_ = -static_cast<int64_t>(taps_ - 1);
+}
+
+uint64_t PolyphaseResampler::outputLength(uint64_t inputLength) const {
+    return (inputLength * L_ + M_ - 1) / M_;
+}
+
+void PolyphaseResampler::produce(std::vector<float>& out, uint64_t limitOut) {
+    const int64_t bufEnd = bufStart_ + static_cast<int64_t>(buf_.size());
+
+    while (outCount_ < limitOut) {
+        const uint64_t pos = outCount_ * M_ + center_;
+        const int64_t  n   = static_cast<int64_t>(pos / L_);
+        const uint32_t p   = static_cast<uint32_t>(pos % L_);
+        if (n >= bufEnd) break;
+
+        const float* x = buf_.data() + (n - taps_ + 1 - bufStart_);
+        out.push_back(dot_(x, bank_.data() + static_cast<size_t>(p) * taps_, taps_));
+        ++outCount_;
+    }
+
+    // 丢弃后续输出不再需要的历史样本
+    const int64_t nextN = static_cast<int64_t>((outCount_ * M_ + center_) / L_);
+    const int64_t keepFrom = nextN - taps_ + 1;
+    if (keepFrom > bufStart_) {
+        const size_t drop = static_cast<size_t>(std::min<int64_t>(keepFrom - bufStart_,
+                                                                  static_cast<int64_t>(buf_.size())));
+        buf_.erase(buf_.begin(), buf_.begin() + static_cast<std::ptrdiff_t>(drop));
+        bufStart_ += static_cast<int64_t>(drop);
+    }
+}
+
+void PolyphaseResampler::process(const float* in, size_t count, std::vector<float>& out) {
+    buf_.insert(buf_.end(), in, in + count);
+    inCount_ += count;
+    produce(out, outputLength(inCount_));
+}
+
+void PolyphaseResampler::flush(std::vector<float>& out) {
+    const uint64_t total = outputLength(inCount_);
+    if (outCount_ >= total) return;
+
+    // 补零直到最后一个输出所需的输入都在缓冲内
+    const int64_t lastN = static_cast<int64_t>(((total - 1) * M_ + center_) / L_);
+    const int64_t bufEnd = bufStart_ + static_cast<int64_t>(buf_.size());
+    if (lastN >= bufEnd) {
+        buf_.resize(buf_.size() + static_cast<size_t>(lastN - bufEnd + 1), 0.0f);
+    }
+    produce(out, total);
+}
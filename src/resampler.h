@@ -0,0 +1,41 @@
+// src/resampler.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// 流式多相有理数重采样器：outRate / inRate = L / M（已约分）
+// 原型低通滤波器（Kaiser 窗 sinc）在构造时拆成 L 组相位滤波器，
+// 每个输出样本只需一次 tapsPerPhase 点的 FIR 点积
+// 输出按滤波器群时延对齐：输出样本 m 与输入时刻 m * inRate / outRate 对齐
+class PolyphaseResampler {
+public:
+    PolyphaseResampler(uint32_t inRate, uint32_t outRate, int tapsPerPhase = 24);
+
+    uint32_t upFactor() const { return L_; }
+    uint32_t downFactor() const { return M_; }
+
+    // 输入 count 个样本，产生的输出样本追加到 out
+    void process(const float* in, size_t count, std::vector<float>& out);
+
+    // 输入结束：补零冲出滤波器中剩余的输出，使总输出数为 ceil(totalIn * L / M)
+    void flush(std::vector<float>& out);
+
+    // 给定输入样本数，对应的总输出样本数
+    uint64_t outputLength(uint64_t inputLength) const;
+
+private:
+    void produce(std::vector<float>& out, uint64_t limitOut);
+
+    uint32_t L_;
+    uint32_t M_;
+    int      taps_;
+    uint64_t center_;           // 原型滤波器中心（上采样域）
+    float  (*dot_)(const float*, const float*, int);   // 按 CPU 分派的 FIR 点积内核
+
+    std::vector<float> bank_;   // L_ 组相位，每组 taps_ 个系数（已反序，便于连续点积）
+    std::vector<float> buf_;    // 输入历史：buf_[i] 对应输入序号 bufStart_ + i
+    int64_t  bufStart_ = 0;     // 初始为 -(taps_ - 1)，即开头补的零
+    uint64_t inCount_  = 0;     // 已输入的真实样本数
+    uint64_t outCount_ = 0;     // 已产生的输出样本数
+};
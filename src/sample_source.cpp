@@ -0,0 +1,76 @@
+// src/sample_source.cpp
+#include "sample_source.h"
+#include "demod_q15.h"
+
+#include <algorithm>
+
+SampleSource::SampleSource(WavReader& reader, uint32_t targetRate) : reader_(reader) {
+    if (reader.info().sampleRate != targetRate) {
+        resampler_.reset(new PolyphaseResampler(reader.info().sampleRate, targetRate));
+    }
+}
+
+uint64_t SampleSource::totalSamples() const {
+    const uint64_t n = reader_.info().numFrames;
+    return resampler_ ? resampler_->outputLength(n) : n;
+}
+
+size_t SampleSource::read(float* out, size_t count) {
+    return resampler_ ? drain(out, count, false) : reader_.read(out, count);
+}
+
+size_t SampleSource::readSome(float* out, size_t count) {
+    return resampler_ ? drain(out, count, true) : reader_.readSome(out, count);
+}
+
+size_t SampleSource::read(int16_t* out, size_t count) {
+    return resampler_ ? drain(out, count, false) : reader_.read(out, count);
+}
+
+size_t SampleSource::readSome(int16_t* out, size_t count) {
+    return resampler_ ? drain(out, count, true) : reader_.readSome(out, count);
+}
+
+size_t SampleSource::drain(int16_t* out, size_t count, bool partial) {
+    pcm_.resize(count);
+    const size_t n = drain(pcm_.data(), count, partial);
+    floatToInt16(pcm_.data(), out, static_cast<uint32_t>(n));
+    return n;
+}
+
+size_t SampleSource::drain(float* out, size_t count, bool partial) {
+    const size_t want = partial ? std::min<size_t>(count, 1) : count;
+    while (fifo_.size() - fifoPos_ < want && !flushed_) {
+        if (fifoPos_ > 0) {
+            fifo_.erase(fifo_.begin(), fifo_.begin() + static_cast<std::ptrdiff_t>(fifoPos_));
+            fifoPos_ = 0;
+        }
+        block_.resize(kBlock);
+        size_t got = partial ? reader_.readSome(block_.data(), block_.size())
+                             : reader_.read(block_.data(), block_.size());
+        if (got > 0) {
+            resampler_->process(block_.data(), got, fifo_);
+        } else {
+            resampler_->flush(fifo_);
+            flushed_ = true;
+        }
+    }
+
+    size_t n = std::min(count, fifo_.size() - fifoPos_);
+    std::copy(fifo_.begin() + static_cast<std::ptrdiff_t>(fifoPos_),
+              fifo_.begin() + static_cast<std::ptrdiff_t>(fifoPos_ + n), out);
+    fifoPos_ += n;
+    return n;
+}
+
+uint64_t SampleSource::skip(uint64_t count) {
+    uint64_t done = 0;
+    std::vector<float> sink(kBlock);
+    while (done < count) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(count - done, kBlock));
+        size_t got = read(sink.data(), want);
+        if (got == 0) break;
+        done += got;
+    }
+    return done;
+}
@@ -0,0 +1,54 @@
+// src/sample_source.h
+#pragma once
+#include "wav_io.h"
+#include "resampler.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// 解调前的样本源：WAV 采样率与目标采样率不一致时，经多相重采样器转换到 targetRate
+// 重采样器构造失败（非法采样率）时抛 std::runtime_error
+class SampleSource {
+public:
+    SampleSource(WavReader& reader, uint32_t targetRate);
+
+    bool resampling() const { return resampler_ != nullptr; }
+
+    // 目标采样率下的总样本数（lengthKnown 为 false 时无意义，只能读到 EOF）
+    uint64_t totalSamples() const;
+    bool lengthKnown() const { return reader_.info().sizeKnown; }
+
+    // 读取 count 个样本，返回实际读到的数量
+    size_t read(float* out, size_t count);
+
+    // 只等到至少一个样本就返回已有的部分（stdin / 管道上不等凑满 count），0 表示 EOF
+    size_t readSome(float* out, size_t count);
+
+    // 定点解调用的 int16 样本：不重采样时由 WavReader 直接取出（16-bit PCM 不经浮点），
+    // 重采样器是浮点的，重采样时把它的输出取整
+    size_t read(int16_t* out, size_t count);
+    size_t readSome(int16_t* out, size_t count);
+
+    // 可由其它线程调用：让阻塞在 read / readSome 中的读取立即按 EOF 返回
+    void cancel() { reader_.cancel(); }
+
+    // 丢弃 count 个样本，返回实际丢弃的数量
+    uint64_t skip(uint64_t count);
+
+private:
+    static constexpr size_t kBlock = 4096;
+
+    // 经重采样器取 count 个样本；partial 时有至少一个样本就返回
+    size_t drain(float* out, size_t count, bool partial);
+    size_t drain(int16_t* out, size_t count, bool partial);
+
+    WavReader& reader_;
+    std::unique_ptr<PolyphaseResampler> resampler_;
+    std::vector<float> block_;
+    std::vector<float> fifo_;
+    std::vector<float> pcm_;     // 重采样后取整前的 float 样本
+    size_t fifoPos_ = 0;
+    bool flushed_ = false;
+};
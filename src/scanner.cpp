@@ -0,0 +1,400 @@
+// src/scanner.cpp
+#include "scanner.h"
+#include "sample_source.h"
+#include "wav_io.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr size_t FRAME_MAX_PAYLOAD  = 0xFFFF;
+constexpr int    ALIGN_SYMBOLS      = 8;        // 前导对齐使用的符号数
+constexpr double ALIGN_MIN_SCORE    = 0.5;      // 每符号平均归一化对比度下限
+
+// 去直流后的块能量
+double blockEnergy(const float* x, size_t n) {
+    double sum = 0.0;
+    double sq = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += x[i];
+        sq  += static_cast<double>(x[i]) * x[i];
+    }
+    return sq - sum * sum / static_cast<double>(n);
+}
+
+class BurstScanner {
+public:
+    BurstScanner(const DecoderPlan& plan, const BurstHandler& onFrame, ScanStats& stats)
+        : plan_(plan),
+          onFrame_(onFrame),
+          stats_(stats),
+          N_(plan.demod.N),
+          syncSamples_(static_cast<size_t>(plan.params.syncSymbols) * plan.demod.N),
+          bitsPerSymbol_(static_cast<size_t>(plan.demod.subbands) * plan.demod.toneBits) {
+        // 前导在所有子带同时发 tone0 / tone15：系数按 [子带 k 的 tone0, 子带 k 的 tone15] 排列
+        const int A = plan.demod.tonesPerBand;
+        for (int band = 0; band < plan.demod.subbands; ++band) {
+            edgeCoeffs_.push_back(plan.demod.coeffs[static_cast<size_t>(band) * A]);
+            edgeCoeffs_.push_back(plan.demod.coeffs[static_cast<size_t>(band) * A + A - 1]);
+        }
+    }
+
+    // 最长一次传输（最大 payload）的样本数，决定候选区缓冲上限
+    size_t maxTransmissionSamples() const {
+        return syncSamples_ + dataSymbols(FRAME_MAX_PAYLOAD) * N_;
+    }
+
+    // 在一个候选区内寻找并解码所有帧。buf[0] 对应绝对样本序号 bufStart，
+    // threshold 为候选区打开时的块能量门限
+    void processRegion(const std::vector<float>& buf, uint64_t bufStart, double threshold) {
+        size_t pos = 0;
+        if (emittedEnd_ > bufStart) {
+            pos = static_cast<size_t>(std::min<uint64_t>(emittedEnd_ - bufStart, buf.size()));
+        }
+
+        const size_t minSamples = syncSamples_ + N_;
+        while (buf.size() - pos >= minSamples) {
+            // 从 pos 起第一个高于门限的块
+            size_t g = pos;
+            while (g + N_ <= buf.size() && blockEnergy(buf.data() + g, N_) <= threshold) {
+                g += N_;
+            }
+            if (buf.size() - g < minSamples) {
+                return;
+            }
+
+            size_t start = 0;
+            if (alignPreamble(buf, pos, g, start)) {
+                size_t used = 0;
+                if (tryCandidates(buf, bufStart, pos, start, used)) {
+                    pos = start + used;   // tryCandidates 把 start 改成实际帧起点
+                    continue;
+                }
+            }
+            pos = g + N_;
+        }
+    }
+
+private:
+    // payload 字节数 -> 数据符号数（与编码端的 FEC + 补齐一致）
+    size_t dataSymbols(size_t payloadLen) const {
+        const size_t coded = frameCodedBits(payloadLen, plan_.params.fec, plan_.params.tailBiting);
+        return (coded + bitsPerSymbol_ - 1) / bitsPerSymbol_;
+    }
+
+    // 窗口 [p, p+N) 上 tone0 对 tone15 的对比度，按窗内能量归一化
+    // 这里故意不加 Hann 窗：bin 对齐的单音在矩形窗下没有泄漏，Goertzel 能量为窗内能量的 N/2 倍，
+    // 窗口错开 d 个样本时对比度约为 1 - 2d/N，对定时比加窗时敏感得多。
+    // +1 ≈ 纯 tone0，-1 ≈ 纯 tone15，两者都不存在（数据符号、噪声）时接近 0
+    double edgeContrast(const float* p) {
+        double energy = 0.0;
+        for (size_t i = 0; i < N_; ++i) {
+            energy += static_cast<double>(p[i]) * p[i];
+        }
+        goertzelBank(p, static_cast<uint32_t>(N_), edgeCoeffs_, scratch_);
+        double p0 = 0.0;
+        double p1 = 0.0;
+        for (size_t j = 0; j < edgeCoeffs_.size(); j += 2) {
+            p0 += scratch_.powers[j];
+            p1 += scratch_.powers[j + 1];
+        }
+        return (p0 - p1) / (energy * static_cast<double>(N_) / 2.0 + 1e-12);
+    }
+
+    // 以 o 起的 ALIGN_SYMBOLS 个符号与“tone0 / tone15 交替”的吻合度
+    double preambleScore(const std::vector<float>& buf, size_t o) {
+        double score = 0.0;
+        for (int k = 0; k < ALIGN_SYMBOLS; ++k) {
+            double c = edgeContrast(buf.data() + o + static_cast<size_t>(k) * N_);
+            score += (k % 2 == 0) ? c : -c;
+        }
+        return score;
+    }
+
+    // 在 g 附近 2N 范围内找前导相位（交替图样周期为 2N，范围内唯一），
+    // 再按 2N 向前回溯到前导起点（不越过 pos）
+    bool alignPreamble(const std::vector<float>& buf, size_t pos, size_t g, size_t& start) {
+        const int alignSymbols = std::min(ALIGN_SYMBOLS, plan_.params.syncSymbols);
+        const size_t span = static_cast<size_t>(alignSymbols) * N_;
+        const size_t lo = std::max(pos, g >= N_ ? g - N_ : 0);
+        const size_t hi = g + N_;
+        if (alignSymbols < 2 || lo + span > buf.size()) {
+            return false;
+        }
+        const size_t last = std::min(hi, buf.size() - span);
+
+        // 粗搜索 N/8 步长，再逐步减半细化
+        size_t step = std::max<size_t>(1, N_ / 8);
+        size_t best = lo;
+        double bestScore = -1e30;
+        for (size_t o = lo; o <= last; o += step) {
+            double sc = preambleScore(buf, o);
+            if (sc > bestScore) {
+                bestScore = sc;
+                best = o;
+            }
+        }
+        if (bestScore < ALIGN_MIN_SCORE * alignSymbols * 0.5) {
+            return false;    // 粗搜索就远低于门限，不是前导
+        }
+        for (step /= 2; step >= 1; step /= 2) {
+            const size_t center = best;
+            for (size_t o : {center >= step ? center - step : center, center + step}) {
+                if (o < lo || o > last || o == center) continue;
+                double sc = preambleScore(buf, o);
+                if (sc > bestScore) {
+                    bestScore = sc;
+                    best = o;
+                }
+            }
+        }
+        if (bestScore < ALIGN_MIN_SCORE * alignSymbols) {
+            return false;
+        }
+
+        // 向前回溯：前一对符号仍是 tone0 / tone15 时前导起点再提前 2N
+        start = best;
+        const int maxBack = plan_.params.syncSymbols / 2;
+        for (int k = 0; k < maxBack && start >= pos + 2 * N_; ++k) {
+            const float* p = buf.data() + start - 2 * N_;
+            if (edgeContrast(p) < ALIGN_MIN_SCORE || -edgeContrast(p + N_) < ALIGN_MIN_SCORE) {
+                break;
+            }
+            start -= 2 * N_;
+        }
+        ++stats_.candidates;
+        return true;
+    }
+
+    // 前导起点 s 处的帧头前缀检查：只解调开头几个符号，截断 Viterbi 解出 5 字节帧头，
+    // marker 不符或长度超出候选区时直接放弃。通过时返回整次传输的样本数
+    bool checkPrefix(const std::vector<float>& buf, size_t s, size_t& totalSamples) {
+        const size_t dataStart = s + syncSamples_;
+        const bool fec = plan_.params.fec;
+        const size_t prefixCoded = framePrefixCodedBits(fec);
+        const size_t prefixSymbols = (prefixCoded + bitsPerSymbol_ - 1) / bitsPerSymbol_;
+        if (dataStart + prefixSymbols * N_ > buf.size()) {
+            return false;
+        }
+
+        ws_.codedBits.clear();
+        demodulateSymbols(buf.data() + dataStart, prefixSymbols, plan_, ws_, ws_.codedBits);
+
+        size_t len = 0;
+        if (!peekFrameHeader(ws_.codedBits.data(), ws_.codedBits.size(), fec, plan_.params.tailBiting, ws_, len)) {
+            return false;
+        }
+        totalSamples = syncSamples_ + dataSymbols(len) * N_;
+        return fitStart(buf, s, totalSamples) + totalSamples <= buf.size();
+    }
+
+    // 对齐误差只有几个样本，但候选区恰好在传输末尾截止时，晚 1~2 个样本就会少一个符号；
+    // 此时把起点向前挪到刚好容纳整次传输
+    size_t fitStart(const std::vector<float>& buf, size_t s, size_t totalSamples) const {
+        if (s + totalSamples > buf.size()) {
+            const size_t over = s + totalSamples - buf.size();
+            if (over <= N_ / 4 && over <= s) {
+                return s - over;
+            }
+        }
+        return s;
+    }
+
+    // 依次尝试 start、start + 2N、start - 2N（前导开头一对符号被削弱时回溯可能差一个周期）
+    bool tryCandidates(const std::vector<float>& buf, uint64_t bufStart, size_t pos,
+                       size_t& start, size_t& used) {
+        const size_t base = start;
+        size_t cands[3] = {base, base + 2 * N_, base};
+        int numCands = 2;
+        if (base >= pos + 2 * N_) {
+            cands[numCands++] = base - 2 * N_;
+        }
+
+        for (int i = 0; i < numCands; ++i) {
+            size_t total = 0;
+            if (!checkPrefix(buf, cands[i], total)) {
+                ++stats_.markerRejects;
+                continue;
+            }
+            const size_t s = fitStart(buf, cands[i], total);
+
+            PayloadView payload;
+            if (!decodeSamples(buf.data() + s, total, plan_, ws_, payload)) {
+                ++stats_.decodeFailures;
+                continue;
+            }
+
+            BurstFrame frame;
+            frame.index = stats_.frames;
+            frame.sampleOffset = bufStart + s;
+            frame.timeSec = static_cast<double>(frame.sampleOffset) / plan_.params.sampleRate;
+            frame.payload = payload;
+            emittedEnd_ = bufStart + s + total;
+            onFrame_(frame);
+            ++stats_.frames;
+
+            start = s;
+            used = total;
+            return true;
+        }
+        return false;
+    }
+
+    const DecoderPlan&  plan_;
+    const BurstHandler& onFrame_;
+    ScanStats&          stats_;
+    const size_t        N_;
+    const size_t        syncSamples_;
+    const size_t        bitsPerSymbol_;
+    std::vector<float>  edgeCoeffs_;     // 各子带 tone0 与 tone15 的 Goertzel 系数
+    DemodScratch        scratch_;
+    DecodeWorkspace     ws_;
+    uint64_t            emittedEnd_ = 0; // 已输出帧的结束位置（绝对样本序号），防止重叠区重复输出
+};
+
+} // namespace
+
+bool scanWavForBursts(
+    const std::string& inputWavPath,
+    const DecoderPlan& plan,
+    const ScanParams& scan,
+    const BurstHandler& onFrame,
+    ScanStats& stats
+) {
+    stats = ScanStats{};
+    if (plan.params.adaptive) {
+        std::cerr << "Scan mode does not support --adaptive\n";
+        return false;
+    }
+
+    WavReader reader;
+    if (!(plan.params.rawPcm ? reader.openRawPcm16(inputWavPath, plan.params.sampleRate)
+                             : reader.open(inputWavPath))) {
+        return false;
+    }
+
+    std::unique_ptr<SampleSource> source;
+    try {
+        source.reset(new SampleSource(reader, plan.params.sampleRate));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return false;
+    }
+
+    BurstScanner scanner(plan, onFrame, stats);
+    const size_t N = plan.demod.N;
+    const size_t maxTx = scanner.maxTransmissionSamples();
+    const double gate = std::pow(10.0, scan.gateDb / 10.0);
+    const double absFloor = scan.minRms * scan.minRms * static_cast<double>(N);
+
+    // 噪声底：先用开头一段（约 1 秒）块能量的 10% 分位数初始化，
+    // 之后遇到更低的块立即下调，非活动块缓慢上调；候选区打开期间冻结
+    const size_t calibBlocks = std::max<size_t>(64, plan.params.sampleRate / N);
+    std::vector<float> calib;
+    std::vector<double> calibEnergy;
+    std::vector<float> block(N);
+    while (calibEnergy.size() < calibBlocks && source->read(block.data(), N) == N) {
+        calib.insert(calib.end(), block.begin(), block.end());
+        calibEnergy.push_back(blockEnergy(block.data(), N));
+    }
+    double floor = 0.0;
+    if (!calibEnergy.empty()) {
+        std::vector<double> sorted(calibEnergy);
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 10, sorted.end());
+        floor = sorted[sorted.size() / 10];
+    }
+
+    std::vector<float> region;
+    std::vector<float> prev;             // 上一块，候选区打开时作为前置余量
+    uint64_t regionStart = 0;
+    uint64_t blockStart = 0;
+    double threshold = 0.0;
+    bool inRegion = false;
+    int quiet = 0;
+
+    // 录音可能从一次传输中间（或开头）开始，此时初始噪声底就是信号电平，门限永远打不开。
+    // 因此保留从文件开头起的样本（最多一次最长传输），若之后能量骤降到噪声底以下 gate 倍，
+    // 说明开头是信号，把这一段作为候选区补扫一次
+    std::vector<float> head;
+    bool headPending = true;
+
+    auto feed = [&](const float* x) {
+        const double e = blockEnergy(x, N);
+        const double thr = std::max(floor * gate, absFloor);
+        const bool active = e > thr;
+        ++stats.blocks;
+        if (active) ++stats.activeBlocks;
+
+        if (headPending) {
+            if (!inRegion && e * gate < floor && floor > absFloor) {
+                ++stats.regions;
+                scanner.processRegion(head, 0, std::max(e * gate, absFloor));
+                headPending = false;
+            } else if (head.size() > maxTx) {
+                headPending = false;
+            } else {
+                head.insert(head.end(), x, x + N);
+            }
+            if (!headPending) {
+                head.clear();
+                head.shrink_to_fit();
+            }
+        }
+
+        if (e < floor) {
+            floor = e;
+        } else if (!active || region.size() > maxTx) {
+            // 候选区远超最长传输时说明噪声底抬升了，允许门限跟上
+            floor += (e - floor) / 64.0;
+        }
+
+        if (active && !inRegion) {
+            inRegion = true;
+            quiet = 0;
+            threshold = thr;
+            region.assign(prev.begin(), prev.end());
+            regionStart = blockStart - prev.size();
+            ++stats.regions;
+        }
+        if (inRegion) {
+            region.insert(region.end(), x, x + N);
+            quiet = active ? 0 : quiet + 1;
+            if (quiet > scan.hangBlocks) {
+                scanner.processRegion(region, regionStart, threshold);
+                inRegion = false;
+                region.clear();
+            } else if (region.size() > 2 * maxTx) {
+                // 超长候选区：先处理，再保留末尾一段最长传输长度，跨边界的帧在下一轮完整出现
+                scanner.processRegion(region, regionStart, threshold);
+                const size_t drop = region.size() - maxTx;
+                region.erase(region.begin(), region.begin() + static_cast<std::ptrdiff_t>(drop));
+                regionStart += drop;
+            }
+        }
+        prev.assign(x, x + N);
+        blockStart += N;
+    };
+
+    for (size_t i = 0; i < calibEnergy.size(); ++i) {
+        feed(calib.data() + i * N);
+    }
+    calib.clear();
+    calib.shrink_to_fit();
+    while (source->read(block.data(), N) == N) {
+        feed(block.data());
+    }
+    if (inRegion) {
+        scanner.processRegion(region, regionStart, threshold);
+    }
+    // 门限从未打开、电平也没有骤降过（例如整段只有一次传输、没有静音）：开头一段同样补扫
+    if (headPending && !head.empty() && stats.activeBlocks == 0 && floor > absFloor) {
+        ++stats.regions;
+        scanner.processRegion(head, 0, absFloor);
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+// src/scanner.h
+#pragma once
+#include "decoder.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// 长录音突发扫描：先用块能量门限跳过静音，只对候选区做前导对齐 + 帧头前缀检查，
+// 前缀（A5 5A + 长度）正确时才做完整解调 + Viterbi + parseFrame
+struct ScanParams {
+    double gateDb     = 10.0;   // 块能量高于噪声底多少 dB 视为有信号
+    double minRms     = 64.0;   // 绝对门限（样本 RMS，16-bit 满幅尺度），数字静音时噪声底为 0
+    int    hangBlocks = 4;      // 连续多少块低于门限后结束候选区
+};
+
+struct ScanStats {
+    uint64_t blocks         = 0;   // 门限检测的块数（每块一个符号长度）
+    uint64_t activeBlocks   = 0;   // 高于门限的块数
+    uint64_t regions        = 0;   // 候选区数
+    uint64_t candidates     = 0;   // 前导对齐成功、做了帧头前缀检查的位置数
+    uint64_t markerRejects  = 0;   // 帧头前缀不符（marker 或长度），提前放弃
+    uint64_t decodeFailures = 0;   // 前缀正确但完整解码失败（CRC 等）
+    uint64_t frames         = 0;
+};
+
+struct BurstFrame {
+    uint64_t    index        = 0;  // 第几个帧（从 0 起）
+    uint64_t    sampleOffset = 0;  // 前导起点（plan 采样率下的样本序号）
+    double      timeSec      = 0.0;
+    PayloadView payload;           // 指向扫描器内部缓冲，回调返回后失效
+};
+
+using BurstHandler = std::function<void(const BurstFrame&)>;
+
+// 扫描整段录音，每找到一个合法帧调用一次 onFrame（按时间顺序）
+// 需要非自适应参数；打开文件或参数非法时打印原因并返回 false
+bool scanWavForBursts(
+    const std::string& inputWavPath,
+    const DecoderPlan& plan,
+    const ScanParams& scan,
+    const BurstHandler& onFrame,
+    ScanStats& stats
+);
@@ -0,0 +1,125 @@
+// src/spsc_ring.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// 单生产者 / 单消费者的有界无锁环形队列（流水线各级之间的连接）
+//
+// 元素按交换（swap）进出：push 把 item 换进槽位，item 换回该槽位上一次被消费者换出的旧对象；
+// pop 同理。缓冲因此在生产者和消费者之间循环使用，稳态下不分配内存。
+// 每个元素本身应是一批数据（一块样本、一整帧），一次交接摊薄同步开销
+//
+// 统计字段分别只由生产者 / 消费者写，两端线程结束后再读
+struct RingStats {
+    uint64_t pushes      = 0;   // 入队元素数
+    uint64_t fullStalls  = 0;   // 生产者遇到队满而等待的次数（下游是瓶颈）
+    uint64_t emptyStalls = 0;   // 消费者遇到队空而等待的次数（上游是瓶颈）
+    uint64_t depthSum    = 0;   // 每次入队后的队列深度之和，平均深度 = depthSum / pushes
+    uint64_t maxDepth    = 0;
+};
+
+template <typename T>
+class SpscRing {
+public:
+    // capacity 取整到 2 的幂
+    explicit SpscRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        slots_.resize(n);
+        mask_ = n - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return slots_.size(); }
+
+    // 生产者：队满时返回 false
+    bool tryPush(T& item) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ == slots_.size()) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ == slots_.size()) {
+                return false;
+            }
+        }
+        std::swap(slots_[tail & mask_], item);
+        tail_.store(tail + 1, std::memory_order_release);
+
+        // 深度按消费者当前位置计（headCache_ 只在看似队满时刷新，会偏大）
+        const uint64_t depth = tail + 1 - head_.load(std::memory_order_relaxed);
+        ++stats_.pushes;
+        stats_.depthSum += depth;
+        if (depth > stats_.maxDepth) stats_.maxDepth = depth;
+        return true;
+    }
+
+    // 消费者：队空时返回 false
+    bool tryPop(T& item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) {
+                return false;
+            }
+        }
+        std::swap(slots_[head & mask_], item);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 阻塞版本：等待期间 stop 置位时放弃并返回 false
+    bool push(T& item, const std::atomic<bool>& stop) {
+        if (tryPush(item)) return true;
+        ++stats_.fullStalls;
+        for (unsigned spins = 0; !stop.load(std::memory_order_relaxed); ++spins) {
+            if (tryPush(item)) return true;
+            backoff(spins);
+        }
+        return false;
+    }
+
+    bool pop(T& item, const std::atomic<bool>& stop) {
+        if (tryPop(item)) return true;
+        ++emptyStalls_;
+        for (unsigned spins = 0; !stop.load(std::memory_order_relaxed); ++spins) {
+            if (tryPop(item)) return true;
+            backoff(spins);
+        }
+        return false;
+    }
+
+    // 两端线程都结束后调用
+    RingStats stats() const {
+        RingStats s = stats_;
+        s.emptyStalls = emptyStalls_;
+        return s;
+    }
+
+private:
+    // 先让出时间片，等得久了改为短睡眠，避免在另一级长时间阻塞（磁盘、管道）时空转
+    static void backoff(unsigned spins) {
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    std::vector<T> slots_;
+    size_t         mask_ = 0;
+
+    // 生产者一侧
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t    headCache_ = 0;
+    RingStats stats_;
+
+    // 消费者一侧
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t   tailCache_   = 0;
+    uint64_t emptyStalls_ = 0;
+};
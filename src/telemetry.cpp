@@ -0,0 +1,410 @@
+// src/telemetry.cpp
+#include "telemetry.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+constexpr double POWER_EPS = 1e-20;
+constexpr char   BINARY_MAGIC[8] = { 'F', 'S', 'K', 'T', 'L', 'M', '0', '1' };
+constexpr char   TAG_SYMBOLS = 'S';
+constexpr char   TAG_FRAME   = 'F';
+constexpr size_t SYMBOL_RECORD_BYTES = 24;
+constexpr size_t FRAME_RECORD_BYTES  = 32;   // 不含混淆矩阵
+constexpr size_t SYMBOL_BATCH = 4096;        // 转 CSV 时每批读入的符号记录数
+constexpr int    MAX_ALPHABET = 256;
+
+const char CSV_HEADER[] =
+    "symbol,band,best,second,best_power,second_power,noise_floor,margin_db,snr_db,peak\n";
+
+double ratioDb(double a, double b) {
+    return 10.0 * std::log10((a + POWER_EPS) / (b + POWER_EPS));
+}
+
+void putLE(std::string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+}
+
+uint64_t getLE(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+float getFloat(const uint8_t* p) {
+    const uint32_t u = static_cast<uint32_t>(getLE(p, 4));
+    float f = 0.0f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// 符号行用 to_chars 逐字段拼接，比 printf 系列快得多。
+// 缓冲按最长的字段算：peak 以定点格式输出，float 最大 3.4e38 为 39 位整数加符号
+void formatCsv(const std::vector<SymbolTelemetry>& symbols, const FrameTelemetry* frame,
+               std::string& text) {
+    constexpr size_t CSV_FIELDS = 10;
+    constexpr size_t MAX_FIELD_CHARS = 48;
+    char line[CSV_FIELDS * (MAX_FIELD_CHARS + 1)];
+    char* const end = line + sizeof(line);
+    for (const SymbolTelemetry& s : symbols) {
+        char* p = line;
+        bool fits = true;
+        // 每个字段后跟一个 ','（行尾的换成 '\n'）；放不下时整行丢弃
+        auto store = [&](std::to_chars_result r) {
+            if (r.ec != std::errc{} || r.ptr == end) {
+                fits = false;
+                return;
+            }
+            p = r.ptr;
+            *p++ = ',';
+        };
+        auto put = [&](auto value) {
+            if (fits) store(std::to_chars(p, end, value));
+        };
+        auto putFixed = [&](double value, int precision) {
+            if (fits) store(std::to_chars(p, end, value, std::chars_format::fixed, precision));
+        };
+        put(s.symbol);
+        put(static_cast<unsigned>(s.band));
+        put(static_cast<unsigned>(s.best));
+        put(static_cast<unsigned>(s.second));
+        put(s.bestPower);
+        put(s.secondPower);
+        put(s.noiseFloor);
+        putFixed(ratioDb(s.bestPower, s.secondPower), 2);
+        putFixed(ratioDb(s.bestPower, s.noiseFloor), 2);
+        putFixed(s.peak, 0);
+        if (!fits) continue;
+        p[-1] = '\n';
+        text.append(line, static_cast<size_t>(p - line));
+    }
+    if (!frame) {
+        return;
+    }
+
+    const FrameTelemetry& f = *frame;
+    text += "# frame,header_ok=" + std::to_string(f.headerOk ? 1 : 0) +
+            ",crc_ok=" + std::to_string(f.crcOk ? 1 : 0) +
+            ",payload_len=" + std::to_string(f.payloadLen) +
+            ",data_symbols=" + std::to_string(f.dataSymbols) +
+            ",coded_bits=" + std::to_string(f.codedBits) +
+            ",path_metric=" + std::to_string(f.pathMetric) + "\n";
+
+    const int A = f.alphabet;
+    if (!f.crcOk || A <= 0 || f.confusion.size() != static_cast<size_t>(A) * A) {
+        return;
+    }
+    text += "# confusion (row = sent tone, column = detected tone)\n# sent\\detected";
+    for (int d = 0; d < A; ++d) {
+        text += "," + std::to_string(d);
+    }
+    text += '\n';
+    std::string rates = "# tone_error_rate";
+    for (int t = 0; t < A; ++t) {
+        uint64_t total = 0;
+        text += "# " + std::to_string(t);
+        for (int d = 0; d < A; ++d) {
+            const uint64_t c = f.confusion[static_cast<size_t>(t) * A + d];
+            total += c;
+            text += "," + std::to_string(c);
+        }
+        text += '\n';
+        const uint64_t correct = f.confusion[static_cast<size_t>(t) * A + t];
+        const double rate = total ? static_cast<double>(total - correct) / static_cast<double>(total) : 0.0;
+        char buf[32];
+        char* p = std::to_chars(buf, buf + sizeof(buf), rate, std::chars_format::general, 3).ptr;
+        rates += ',';
+        rates.append(buf, static_cast<size_t>(p - buf));
+    }
+    text += rates + "\n";
+}
+
+// 按字节写到预留好的缓冲里，逐字节 push_back 会让写线程跟不上解调
+char* storeLE(char* p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        *p++ = static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+    return p;
+}
+
+char* storeFloat(char* p, float f) {
+    uint32_t u = 0;
+    std::memcpy(&u, &f, sizeof(u));
+    return storeLE(p, u, 4);
+}
+
+void encodeBinary(const std::vector<SymbolTelemetry>& symbols, const FrameTelemetry* frame,
+                  std::string& out) {
+    if (!symbols.empty()) {
+        const size_t start = out.size();
+        out.resize(start + 5 + symbols.size() * SYMBOL_RECORD_BYTES);
+        char* p = &out[start];
+        *p++ = TAG_SYMBOLS;
+        p = storeLE(p, symbols.size(), 4);
+        for (const SymbolTelemetry& s : symbols) {
+            p = storeLE(p, s.symbol, 4);
+            p = storeLE(p, s.band, 2);
+            *p++ = static_cast<char>(s.best);
+            *p++ = static_cast<char>(s.second);
+            p = storeFloat(p, s.bestPower);
+            p = storeFloat(p, s.secondPower);
+            p = storeFloat(p, s.noiseFloor);
+            p = storeFloat(p, s.peak);
+        }
+    }
+    if (!frame) {
+        return;
+    }
+    const FrameTelemetry& f = *frame;
+    const bool withConfusion =
+        f.alphabet > 0 && f.confusion.size() == static_cast<size_t>(f.alphabet) * f.alphabet;
+    out.push_back(TAG_FRAME);
+    putLE(out, f.headerOk ? 1 : 0, 1);
+    putLE(out, f.crcOk ? 1 : 0, 1);
+    putLE(out, f.payloadLen, 4);
+    putLE(out, f.dataSymbols, 8);
+    putLE(out, f.codedBits, 8);
+    putLE(out, static_cast<uint64_t>(f.pathMetric), 8);
+    putLE(out, withConfusion ? static_cast<uint64_t>(f.alphabet) : 0, 2);
+    if (withConfusion) {
+        for (uint64_t c : f.confusion) {
+            putLE(out, c, 8);
+        }
+    }
+}
+
+} // namespace
+
+TelemetryFormat telemetryFormatForPath(const std::string& path) {
+    const std::string ext = ".csv";
+    if (path.size() >= ext.size()) {
+        std::string tail = path.substr(path.size() - ext.size());
+        std::transform(tail.begin(), tail.end(), tail.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (tail == ext) {
+            return TelemetryFormat::Csv;
+        }
+    }
+    return TelemetryFormat::Binary;
+}
+
+TelemetryWriter::~TelemetryWriter() {
+    close();
+}
+
+bool TelemetryWriter::open(const std::string& path, TelemetryFormat format) {
+    close();
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        std::cerr << "Failed to open telemetry file: " << path << "\n";
+        return false;
+    }
+    path_ = path;
+    format_ = format;
+    if (format_ == TelemetryFormat::Csv) {
+        file_ << CSV_HEADER;
+    } else {
+        file_.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    }
+
+    stopping_ = false;
+    failed_ = false;
+    current_ = Batch{};
+    current_.symbols.reserve(BATCH_RECORDS);
+    worker_ = std::thread(&TelemetryWriter::run, this);
+    return true;
+}
+
+void TelemetryWriter::finishFrame(const FrameTelemetry& frame) {
+    current_.frame = frame;
+    submit(true);
+}
+
+void TelemetryWriter::submit(bool hasFrame) {
+    if (!isOpen()) {
+        current_.symbols.clear();
+        return;
+    }
+    current_.hasFrame = hasFrame;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    spaceCv_.wait(lock, [&] { return queue_.size() < MAX_QUEUED; });
+    queue_.push_back(std::move(current_));
+    if (!free_.empty()) {
+        current_ = std::move(free_.back());
+        free_.pop_back();
+    } else {
+        current_ = Batch{};
+        current_.symbols.reserve(BATCH_RECORDS);
+    }
+    current_.symbols.clear();
+    current_.hasFrame = false;
+    lock.unlock();
+    cv_.notify_one();
+}
+
+bool TelemetryWriter::close() {
+    if (!isOpen()) {
+        return true;
+    }
+    if (!current_.symbols.empty()) {
+        submit(false);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    worker_.join();
+
+    file_.flush();
+    const bool ok = !failed_ && static_cast<bool>(file_);
+    file_.close();
+    if (!ok) {
+        std::cerr << "Failed to write telemetry file: " << path_ << "\n";
+    }
+    queue_.clear();
+    free_.clear();
+    return ok;
+}
+
+void TelemetryWriter::run() {
+    std::string text;
+    for (;;) {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] { return !queue_.empty() || stopping_; });
+            if (queue_.empty()) {
+                return;
+            }
+            batch = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        text.clear();
+        const FrameTelemetry* frame = batch.hasFrame ? &batch.frame : nullptr;
+        if (format_ == TelemetryFormat::Csv) {
+            formatCsv(batch.symbols, frame, text);
+        } else {
+            encodeBinary(batch.symbols, frame, text);
+        }
+        file_.write(text.data(), static_cast<std::streamsize>(text.size()));
+        const bool ok = static_cast<bool>(file_);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ok) {
+                failed_ = true;
+            }
+            free_.push_back(std::move(batch));
+        }
+        spaceCv_.notify_one();
+    }
+}
+
+bool telemetryToCsv(const std::string& binaryPath, std::ostream& out) {
+    std::ifstream in(binaryPath, std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to open telemetry file: " << binaryPath << "\n";
+        return false;
+    }
+    char magic[sizeof(BINARY_MAGIC)] = {};
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) {
+        std::cerr << "Not a binary telemetry file: " << binaryPath << "\n";
+        return false;
+    }
+    out << CSV_HEADER;
+
+    auto readBytes = [&](uint8_t* p, size_t n) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(p), static_cast<std::streamsize>(n)));
+    };
+
+    std::vector<SymbolTelemetry> symbols;
+    std::vector<uint8_t> raw;
+    std::string text;
+    bool corrupt = false;
+    char tag = 0;
+    while (!corrupt && in.get(tag)) {
+        text.clear();
+        if (tag == TAG_SYMBOLS) {
+            uint8_t cnt[4];
+            corrupt = !readBytes(cnt, sizeof(cnt));
+            if (corrupt) break;
+            // 记录数来自文件，按批读入：损坏的计数只会读到 EOF 报错，不会先按它分配内存
+            size_t left = static_cast<size_t>(getLE(cnt, 4));
+            while (left > 0) {
+                const size_t count = std::min(left, SYMBOL_BATCH);
+                raw.resize(count * SYMBOL_RECORD_BYTES);
+                corrupt = !readBytes(raw.data(), raw.size());
+                if (corrupt) break;
+                symbols.resize(count);
+                for (size_t i = 0; i < count; ++i) {
+                    const uint8_t* p = raw.data() + i * SYMBOL_RECORD_BYTES;
+                    SymbolTelemetry& s = symbols[i];
+                    s.symbol      = static_cast<uint32_t>(getLE(p, 4));
+                    s.band        = static_cast<uint16_t>(getLE(p + 4, 2));
+                    s.best        = p[6];
+                    s.second      = p[7];
+                    s.bestPower   = getFloat(p + 8);
+                    s.secondPower = getFloat(p + 12);
+                    s.noiseFloor  = getFloat(p + 16);
+                    s.peak        = getFloat(p + 20);
+                }
+                formatCsv(symbols, nullptr, text);
+                left -= count;
+                if (left > 0) {
+                    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                    text.clear();
+                }
+            }
+            if (corrupt) break;
+        } else if (tag == TAG_FRAME) {
+            uint8_t h[FRAME_RECORD_BYTES];
+            corrupt = !readBytes(h, sizeof(h));
+            if (corrupt) break;
+            FrameTelemetry f;
+            f.headerOk    = h[0] != 0;
+            f.crcOk       = h[1] != 0;
+            f.payloadLen  = static_cast<uint32_t>(getLE(h + 2, 4));
+            f.dataSymbols = getLE(h + 6, 8);
+            f.codedBits   = getLE(h + 14, 8);
+            f.pathMetric  = static_cast<int64_t>(getLE(h + 22, 8));
+            f.alphabet    = static_cast<int>(getLE(h + 30, 2));
+            corrupt = f.alphabet > MAX_ALPHABET;
+            if (corrupt) break;
+            if (f.alphabet > 0) {
+                raw.resize(static_cast<size_t>(f.alphabet) * f.alphabet * 8);
+                corrupt = !readBytes(raw.data(), raw.size());
+                if (corrupt) break;
+                f.confusion.resize(static_cast<size_t>(f.alphabet) * f.alphabet);
+                for (size_t i = 0; i < f.confusion.size(); ++i) {
+                    f.confusion[i] = getLE(raw.data() + i * 8, 8);
+                }
+            }
+            formatCsv({}, &f, text);
+        } else {
+            corrupt = true;
+            break;
+        }
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    if (corrupt) {
+        std::cerr << "Corrupt telemetry file: " << binaryPath << "\n";
+        return false;
+    }
+    out.flush();
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,114 @@
+// src/telemetry.h
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 解码遥测：每个数据符号的判决余量、噪声底和削波情况，每帧的 Viterbi 路径度量，
+// 以及 CRC 通过后重新编码得到的“发送音 → 判决音”混淆矩阵。
+// 用来根据实测数据调 symbolDurationSec / bins，而不是反复试错
+
+// 一个子带的一次判决
+struct SymbolTelemetry {
+    uint32_t symbol      = 0;     // 数据符号序号（不含前导与模式头）
+    uint16_t band        = 0;
+    uint8_t  best        = 0;     // 判决的音序号
+    uint8_t  second      = 0;     // 能量第二的音序号
+    float    bestPower   = 0.0f;
+    float    secondPower = 0.0f;
+    float    noiseFloor  = 0.0f;  // 本子带除最强音外各音能量的中位数（抗主瓣泄漏）
+    float    peak        = 0.0f;  // 预处理前窗口内最大 |样本|，≥ 32767 即削波
+};
+
+// 一帧的汇总
+struct FrameTelemetry {
+    bool     headerOk    = false;  // 帧头 marker 正确
+    bool     crcOk       = false;
+    uint32_t payloadLen  = 0;      // 帧内 payload 字节数（压缩时为压缩后长度）
+    uint64_t dataSymbols = 0;
+    uint64_t codedBits   = 0;
+    int64_t  pathMetric  = -1;     // Viterbi 幸存路径的 Hamming 度量 = 纠正的编码比特数；无 FEC 时为 -1
+    int      alphabet    = 0;      // 每子带音数，confusion 为 alphabet x alphabet
+    std::vector<uint64_t> confusion;   // [sent * alphabet + detected]，仅 crcOk 时有效
+};
+
+enum class TelemetryFormat {
+    Csv,      // 直接可读，格式化开销较大
+    Binary,   // 紧凑二进制，写线程只做字节拼接；可事后用 telemetryToCsv 转成 CSV
+};
+
+// 按扩展名选格式：.csv 为 CSV，其余为二进制
+TelemetryFormat telemetryFormatForPath(const std::string& path);
+
+// 异步写出边车文件：解码线程只把记录追加到当前批次，批次满后交给写线程编码并写盘，
+// 批次缓冲循环复用。写线程跟不上时解码线程等待（队列有上限），不会无限占内存
+//
+// CSV：首行为表头，每个符号每个子带一行
+//   symbol,band,best,second,best_power,second_power,noise_floor,margin_db,snr_db,peak
+// 帧汇总和混淆矩阵以 "#" 开头的注释行紧跟在该帧的符号之后
+//
+// 二进制（全部小端）：8 字节 "FSKTLM01"，之后为若干块，块首 1 字节标记
+//   'S' u32 count，count 条 24 字节记录：u32 symbol, u16 band, u8 best, u8 second,
+//       f32 best_power, f32 second_power, f32 noise_floor, f32 peak
+//   'F' u8 header_ok, u8 crc_ok, u32 payload_len, u64 data_symbols, u64 coded_bits,
+//       i64 path_metric, u16 alphabet, alphabet^2 个 u64 混淆矩阵（行 = 发送音）
+class TelemetryWriter {
+public:
+    TelemetryWriter() = default;
+    ~TelemetryWriter();
+
+    TelemetryWriter(const TelemetryWriter&) = delete;
+    TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+    // 打开失败时打印原因并返回 false
+    bool open(const std::string& path, TelemetryFormat format);
+
+    bool isOpen() const { return worker_.joinable(); }
+
+    void addSymbol(const SymbolTelemetry& s) {
+        current_.symbols.push_back(s);
+        if (current_.symbols.size() >= BATCH_RECORDS) {
+            submit(false);
+        }
+    }
+
+    void finishFrame(const FrameTelemetry& frame);
+
+    // 写完队列中剩余的记录并关闭文件；写盘出错时打印原因并返回 false
+    bool close();
+
+private:
+    static constexpr size_t BATCH_RECORDS = 4096;
+    static constexpr size_t MAX_QUEUED    = 16;
+
+    struct Batch {
+        std::vector<SymbolTelemetry> symbols;
+        bool                         hasFrame = false;
+        FrameTelemetry               frame;
+    };
+
+    void submit(bool hasFrame);
+    void run();
+
+    std::ofstream      file_;
+    std::string        path_;
+    TelemetryFormat    format_ = TelemetryFormat::Csv;
+    Batch              current_;
+
+    std::mutex              mutex_;
+    std::condition_variable cv_;        // 写线程等待新批次
+    std::condition_variable spaceCv_;   // 解码线程等待队列腾出空间
+    std::deque<Batch>       queue_;
+    std::vector<Batch>      free_;      // 写完的批次，缓冲留给解码线程复用
+    bool                    stopping_ = false;
+    bool                    failed_   = false;
+    std::thread             worker_;
+};
+
+// 二进制遥测文件转 CSV（格式与直接写 CSV 相同）；文件损坏时打印原因并返回 false
+bool telemetryToCsv(const std::string& binaryPath, std::ostream& out);
@@ -0,0 +1,98 @@
+// src/thread_pool.cpp
+#include "thread_pool.h"
+
+WorkStealingPool::WorkStealingPool(unsigned numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0) numThreads = 1;
+    }
+
+    for (unsigned i = 0; i < numThreads; ++i) {
+        queues_.emplace_back(new TaskQueue);
+    }
+    for (unsigned i = 0; i < numThreads; ++i) {
+        workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stop_ = true;
+    }
+    workAvailable_.notify_all();
+    for (auto& t : workers_) {
+        t.join();
+    }
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    unsigned q = nextQueue_.fetch_add(1, std::memory_order_relaxed) % size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        ++queued_;
+        ++pending_;
+    }
+    workAvailable_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    allDone_.wait(lock, [this] { return pending_ == 0; });
+}
+
+bool WorkStealingPool::popLocal(unsigned self, std::function<void()>& task) {
+    TaskQueue& q = *queues_[self];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned self, std::function<void()>& task) {
+    const unsigned n = size();
+    for (unsigned k = 1; k < n; ++k) {
+        TaskQueue& q = *queues_[(self + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned self) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex_);
+            workAvailable_.wait(lock, [this] { return stop_ || queued_ > 0; });
+            if (queued_ == 0) return;   // stop_ 且已无任务
+        }
+
+        std::function<void()> task;
+        if (!popLocal(self, task) && !steal(self, task)) {
+            // 任务已被其它线程取走，重新等待
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            --queued_;
+        }
+
+        task();
+
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            done = (--pending_ == 0);
+        }
+        if (done) allDone_.notify_all();
+    }
+}
@@ -0,0 +1,52 @@
+// src/thread_pool.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 简单的 work-stealing 线程池：
+// 每个工作线程有自己的任务队列，从队尾取自己的任务，空闲时从其它队列的队头“偷”任务，
+// 任务耗时差异大（大小文件混合）时也能保持各线程负载均衡
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned numThreads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    // 提交任务（轮流分配到各线程队列）
+    void submit(std::function<void()> task);
+
+    // 阻塞直到所有已提交任务执行完毕
+    void wait();
+
+private:
+    struct TaskQueue {
+        std::mutex                        mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned self);
+    bool popLocal(unsigned self, std::function<void()>& task);
+    bool steal(unsigned self, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread>                workers_;
+
+    std::mutex              stateMutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable allDone_;
+    size_t                  queued_  = 0;   // 尚未被取走的任务数（受 stateMutex_ 保护）
+    size_t                  pending_ = 0;   // 尚未完成的任务数（受 stateMutex_ 保护）
+    bool                    stop_    = false;
+    std::atomic<unsigned>   nextQueue_{0};
+};
@@ -1,85 +1,414 @@
 #include "wav_io.h"
-#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <string>
 
-bool writeWavMono16(
-    const std::string& path,
-    const std::vector<int16_t>& samples,
-    uint32_t sampleRate
-) {
-    WavHeader header{};
-    header.riff[0] = 'R'; header.riff[1] = 'I';
-    header.riff[2] = 'F'; header.riff[3] = 'F';
-    header.wave[0] = 'W'; header.wave[1] = 'A';
-    header.wave[2] = 'V'; header.wave[3] = 'E';
-    header.fmt[0]  = 'f'; header.fmt[1]  = 'm';
-    header.fmt[2]  = 't'; header.fmt[3]  = ' ';
-    header.data[0] = 'd'; header.data[1] = 'a';
-    header.data[2] = 't'; header.data[3] = 'a';
-
-    header.subchunk1Size = 16;
-    header.audioFormat   = 1;
-    header.numChannels   = 1;
-    header.sampleRate    = sampleRate;
-    header.bitsPerSample = 16;
-    header.byteRate      = sampleRate * header.numChannels * header.bitsPerSample / 8;
-    header.blockAlign    = header.numChannels * header.bitsPerSample / 8;
-
-    header.subchunk2Size = static_cast<uint32_t>(samples.size() * header.blockAlign);
-    header.chunkSize     = 36 + header.subchunk2Size;
-
-    std::ofstream ofs(path, std::ios::binary);
-    if (!ofs) {
-        std::cerr << "Failed to open WAV for writing: " << path << "\n";
-        return false;
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM        = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+// RF64 中 32-bit 尺寸字段的占位值，真实值在 ds64 chunk 里
+constexpr uint32_t RF64_SIZE_PLACEHOLDER  = 0xFFFFFFFFu;
+
+void putTag(std::vector<uint8_t>& out, const char* tag) {
+    out.insert(out.end(), tag, tag + 4);
+}
+
+void putLE(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
     }
+}
 
-    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
-    ofs.write(reinterpret_cast<const char*>(samples.data()), samples.size() * sizeof(int16_t));
+uint64_t getLE(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
 
-    return true;
+bool readExact(AsyncReader& in, uint8_t* buf, size_t n) {
+    return in.read(buf, n) == n;
 }
 
-bool readWavMono16(
-    const std::string& path,
-    std::vector<int16_t>& samples,
-    uint32_t& sampleRate
-) {
-    std::ifstream ifs(path, std::ios::binary);
-    if (!ifs) {
+} // namespace
+
+std::vector<uint8_t> makeWavHeaderMono16(uint32_t sampleRate, uint64_t totalSamples) {
+    const uint16_t numChannels   = 1;
+    const uint16_t bitsPerSample = 16;
+    const uint16_t blockAlign    = numChannels * bitsPerSample / 8;
+    const uint32_t byteRate      = sampleRate * blockAlign;
+    const uint64_t dataBytes     = totalSamples * blockAlign;
+
+    // 标准 RIFF：RIFF 尺寸 = 4 ("WAVE") + 24 (fmt) + 8 (data 头) + dataBytes
+    const bool rf64 = dataBytes + 36 > std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint8_t> out;
+    out.reserve(80);
+
+    if (!rf64) {
+        putTag(out, "RIFF");
+        putLE(out, 36 + dataBytes, 4);
+        putTag(out, "WAVE");
+    } else {
+        // RF64：RIFF/data 尺寸填占位值，64-bit 真实尺寸写入紧跟 WAVE 的 ds64 chunk
+        const uint64_t riffSize = 4 + (8 + 28) + (8 + 16) + 8 + dataBytes;
+        putTag(out, "RF64");
+        putLE(out, RF64_SIZE_PLACEHOLDER, 4);
+        putTag(out, "WAVE");
+        putTag(out, "ds64");
+        putLE(out, 28, 4);
+        putLE(out, riffSize, 8);
+        putLE(out, dataBytes, 8);
+        putLE(out, totalSamples, 8);
+        putLE(out, 0, 4);                 // table length
+    }
+
+    putTag(out, "fmt ");
+    putLE(out, 16, 4);
+    putLE(out, WAVE_FORMAT_PCM, 2);
+    putLE(out, numChannels, 2);
+    putLE(out, sampleRate, 4);
+    putLE(out, byteRate, 4);
+    putLE(out, blockAlign, 2);
+    putLE(out, bitsPerSample, 2);
+
+    putTag(out, "data");
+    putLE(out, rf64 ? RF64_SIZE_PLACEHOLDER : dataBytes, 4);
+    return out;
+}
+
+bool WavReader::openStream(const std::string& path) {
+    info_ = WavInfo{};
+    framesLeft_ = 0;
+    dataOffset_ = 0;
+    if (!in_.open(path)) {
         std::cerr << "Failed to open WAV for reading: " << path << "\n";
         return false;
     }
+    return true;
+}
+
+bool WavReader::open(const std::string& path) {
+    return openStream(path) && parseHeader();
+}
+
+bool WavReader::openRawPcm16(const std::string& path, uint32_t sampleRate) {
+    if (!openStream(path)) {
+        return false;
+    }
+    info_.sampleRate    = sampleRate;
+    info_.numChannels   = 1;
+    info_.bitsPerSample = 16;
+    info_.blockAlign    = 2;
+    info_.format        = WavSampleFormat::Int16;
+    info_.sizeKnown     = false;
+    framesLeft_ = std::numeric_limits<uint64_t>::max();
+    return true;
+}
 
-    WavHeader header{};
-    ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
-    if (!ifs) {
-        std::cerr << "Failed to read WAV header: " << path << "\n";
+bool WavReader::parseHeader() {
+    uint8_t hdr[12];
+    if (!readExact(in_, hdr, sizeof(hdr))) {
+        std::cerr << "Failed to read WAV header\n";
         return false;
     }
 
-    if (std::string(header.riff, 4) != "RIFF" ||
-        std::string(header.wave, 4) != "WAVE" ||
-        std::string(header.fmt, 4)  != "fmt " ||
-        std::string(header.data, 4) != "data") {
+    const std::string riffTag(reinterpret_cast<const char*>(hdr), 4);
+    if ((riffTag != "RIFF" && riffTag != "RF64") ||
+        std::memcmp(hdr + 8, "WAVE", 4) != 0) {
         std::cerr << "Invalid WAV format\n";
         return false;
     }
+    info_.rf64 = (riffTag == "RF64");
+
+    uint64_t ds64DataSize = 0;
+    bool haveFmt = false;
+
+    // 逐 chunk 遍历，直到 data chunk；其它 chunk（LIST/fact/JUNK/bext...）直接跳过
+    for (;;) {
+        uint8_t ch[8];
+        if (!readExact(in_, ch, sizeof(ch))) {
+            std::cerr << "WAV data chunk not found\n";
+            return false;
+        }
+        const std::string id(reinterpret_cast<const char*>(ch), 4);
+        uint64_t size = getLE(ch + 4, 4);
+
+        if (id == "ds64") {
+            uint8_t ds[24];
+            if (size < sizeof(ds) || !readExact(in_, ds, sizeof(ds))) {
+                std::cerr << "Invalid ds64 chunk\n";
+                return false;
+            }
+            ds64DataSize = getLE(ds + 8, 8);
+            size -= sizeof(ds);
+        } else if (id == "fmt ") {
+            uint8_t fmt[40] = {};
+            if (size < 16) {
+                std::cerr << "Invalid fmt chunk\n";
+                return false;
+            }
+            const size_t take = static_cast<size_t>(std::min<uint64_t>(size, sizeof(fmt)));
+            if (!readExact(in_, fmt, take)) {
+                std::cerr << "Failed to read fmt chunk\n";
+                return false;
+            }
+            size -= take;
+
+            uint16_t formatTag   = static_cast<uint16_t>(getLE(fmt, 2));
+            info_.numChannels    = static_cast<uint16_t>(getLE(fmt + 2, 2));
+            info_.sampleRate     = static_cast<uint32_t>(getLE(fmt + 4, 4));
+            info_.blockAlign     = static_cast<uint16_t>(getLE(fmt + 12, 2));
+            info_.bitsPerSample  = static_cast<uint16_t>(getLE(fmt + 14, 2));
+
+            // EXTENSIBLE：真实格式在 SubFormat GUID 的前 2 字节
+            if (formatTag == WAVE_FORMAT_EXTENSIBLE) {
+                if (take < 40) {
+                    std::cerr << "Truncated WAVE_FORMAT_EXTENSIBLE fmt chunk\n";
+                    return false;
+                }
+                formatTag = static_cast<uint16_t>(getLE(fmt + 24, 2));
+            }
+
+            if (formatTag == WAVE_FORMAT_PCM && info_.bitsPerSample == 16) {
+                info_.format = WavSampleFormat::Int16;
+            } else if (formatTag == WAVE_FORMAT_PCM && info_.bitsPerSample == 24) {
+                info_.format = WavSampleFormat::Int24;
+            } else if (formatTag == WAVE_FORMAT_PCM && info_.bitsPerSample == 32) {
+                info_.format = WavSampleFormat::Int32;
+            } else if (formatTag == WAVE_FORMAT_IEEE_FLOAT && info_.bitsPerSample == 32) {
+                info_.format = WavSampleFormat::Float32;
+            } else {
+                std::cerr << "Unsupported WAV sample format (format " << formatTag
+                          << ", " << info_.bitsPerSample << "-bit)\n";
+                return false;
+            }
+
+            if (info_.numChannels == 0 ||
+                info_.blockAlign < info_.numChannels * (info_.bitsPerSample / 8)) {
+                std::cerr << "Invalid WAV channel layout\n";
+                return false;
+            }
+            haveFmt = true;
+        } else if (id == "data") {
+            if (!haveFmt) {
+                std::cerr << "WAV data chunk before fmt chunk\n";
+                return false;
+            }
+            dataOffset_ = in_.tell();
+            info_.dataBytes = (info_.rf64 && size == RF64_SIZE_PLACEHOLDER) ? ds64DataSize : size;
+            // 流式写出的 WAV（管道中的 sox/ffmpeg 等）无法回填尺寸，data 尺寸为 0 或 0xFFFFFFFF
+            if (!info_.rf64 && (size == 0 || size == RF64_SIZE_PLACEHOLDER)) {
+                info_.sizeKnown = false;
+                info_.dataBytes = 0;
+                info_.numFrames = 0;
+                framesLeft_ = std::numeric_limits<uint64_t>::max();
+                return true;
+            }
+            info_.numFrames = info_.dataBytes / info_.blockAlign;
+            framesLeft_ = info_.numFrames;
+            return true;
+        }
+
+        // 跳过本 chunk 剩余部分（chunk 按偶数字节对齐）
+        const uint64_t skip = size + (size & 1);
+        if (skip > 0) {
+            // 顺序读过（不 seek，管道输入也可用）
+            if (in_.skip(skip) != skip) {
+                std::cerr << "Truncated WAV chunk: " << id << "\n";
+                return false;
+            }
+        }
+    }
+}
+
+size_t WavReader::readRaw(size_t count, bool partial) {
+    count = static_cast<size_t>(std::min<uint64_t>(count, framesLeft_));
+    if (count == 0) return 0;
+
+    const size_t stride = info_.blockAlign;
+    raw_.resize(count * stride);
+    size_t bytes;
+    if (partial) {
+        bytes = in_.readSome(raw_.data(), raw_.size());
+        // 最后一个样本只到了一部分：等它的其余字节（最多一个 blockAlign）
+        if (bytes % stride != 0) {
+            bytes += in_.read(raw_.data() + bytes, stride - bytes % stride);
+        }
+    } else {
+        bytes = in_.read(raw_.data(), raw_.size());
+    }
+    const size_t got = bytes / stride;
+    const bool eof = partial ? got == 0 : got < count;
+    framesLeft_ = eof ? 0 : framesLeft_ - got;
+    return got;
+}
+
+void WavReader::convert(size_t frames, float* out) const {
+    const size_t stride = info_.blockAlign;
+    const uint8_t* p = raw_.data();
+    switch (info_.format) {
+    case WavSampleFormat::Int16:
+        for (size_t i = 0; i < frames; ++i, p += stride) {
+            out[i] = static_cast<float>(static_cast<int16_t>(getLE(p, 2)));
+        }
+        break;
+    case WavSampleFormat::Int24:
+        for (size_t i = 0; i < frames; ++i, p += stride) {
+            // 左移到 int32 高位再算术右移完成符号扩展
+            int32_t v = static_cast<int32_t>(static_cast<uint32_t>(getLE(p, 3)) << 8) >> 8;
+            out[i] = static_cast<float>(v) * (1.0f / 256.0f);
+        }
+        break;
+    case WavSampleFormat::Int32:
+        for (size_t i = 0; i < frames; ++i, p += stride) {
+            int32_t v = static_cast<int32_t>(static_cast<uint32_t>(getLE(p, 4)));
+            out[i] = static_cast<float>(v) * (1.0f / 65536.0f);
+        }
+        break;
+    case WavSampleFormat::Float32:
+        for (size_t i = 0; i < frames; ++i, p += stride) {
+            uint32_t bits = static_cast<uint32_t>(getLE(p, 4));
+            float v;
+            std::memcpy(&v, &bits, sizeof(v));
+            out[i] = v * 32768.0f;
+        }
+        break;
+    }
+}
 
-    if (header.audioFormat != 1 || header.numChannels != 1 || header.bitsPerSample != 16) {
-        std::cerr << "Only PCM mono 16-bit supported\n";
+// 16-bit PCM 原样取出；更宽的整数格式四舍五入到高 16 位，float 按 ±32768 满幅取整，均饱和
+void WavReader::convert(size_t frames, int16_t* out) const {
+    const size_t stride = info_.blockAlign;
+    const uint8_t* p = raw_.data();
+    auto saturate = [](int64_t v) {
+        return static_cast<int16_t>(std::min<int64_t>(32767, std::max<int64_t>(-32768, v)));
+    };
+    switch (info_.format) {
+    case WavSampleFormat::Int16:
+        for (size_t i = 0; i < frames; ++i, p += stride) {
+            out[i] = static_cast<int16_t>(getLE(p, 2));
+        }
+        break;
+    case WavSampleFormat::Int24:
+        for (size_t i = 0; i < frames; ++i, p += stride) {
+            int32_t v = static_cast<int32_t>(static_cast<uint32_t>(getLE(p, 3)) << 8) >> 8;
+            out[i] = saturate((static_cast<int64_t>(v) + 128) >> 8);
+        }
+        break;
+    case WavSampleFormat::Int32:
+        for (size_t i = 0; i < frames; ++i, p += stride) {
+            int32_t v = static_cast<int32_t>(static_cast<uint32_t>(getLE(p, 4)));
+            out[i] = saturate((static_cast<int64_t>(v) + 32768) >> 16);
+        }
+        break;
+    case WavSampleFormat::Float32:
+        for (size_t i = 0; i < frames; ++i, p += stride) {
+            uint32_t bits = static_cast<uint32_t>(getLE(p, 4));
+            float v;
+            std::memcpy(&v, &bits, sizeof(v));
+            v = std::min(32767.0f, std::max(-32768.0f, v * 32768.0f));
+            out[i] = static_cast<int16_t>(std::lrint(v));
+        }
+        break;
+    }
+}
+
+size_t WavReader::read(float* out, size_t count) {
+    const size_t got = readRaw(count, false);
+    convert(got, out);
+    return got;
+}
+
+size_t WavReader::readSome(float* out, size_t count) {
+    const size_t got = readRaw(count, true);
+    convert(got, out);
+    return got;
+}
+
+size_t WavReader::read(int16_t* out, size_t count) {
+    const size_t got = readRaw(count, false);
+    convert(got, out);
+    return got;
+}
+
+size_t WavReader::readSome(int16_t* out, size_t count) {
+    const size_t got = readRaw(count, true);
+    convert(got, out);
+    return got;
+}
+
+bool WavReader::seekFrame(uint64_t frame) {
+    if (!in_.seek(dataOffset_ + frame * info_.blockAlign)) {
         return false;
     }
+    if (info_.sizeKnown) {
+        framesLeft_ = info_.numFrames - std::min(frame, info_.numFrames);
+    } else {
+        framesLeft_ = std::numeric_limits<uint64_t>::max();
+    }
+    return true;
+}
 
-    sampleRate = header.sampleRate;
-    const size_t numSamples = header.subchunk2Size / (header.bitsPerSample / 8);
-    samples.resize(numSamples);
-    ifs.read(reinterpret_cast<char*>(samples.data()), header.subchunk2Size);
+bool writeWavMono16(
+    const std::string& path,
+    const std::vector<int16_t>& samples,
+    uint32_t sampleRate
+) {
+    std::vector<uint8_t> header = makeWavHeaderMono16(sampleRate, samples.size());
+
+    AsyncWriter out;
+    if (!out.open(path)) {
+        std::cerr << "Failed to open WAV for writing: " << path << "\n";
+        return false;
+    }
+    out.write(header.data(), header.size());
+    out.write(samples.data(), samples.size() * sizeof(int16_t));
+    return out.close();
+}
 
-    if (!ifs) {
-        std::cerr << "Failed to read WAV samples\n";
+bool readWavMono16(
+    const std::string& path,
+    std::vector<int16_t>& samples,
+    uint32_t& sampleRate
+) {
+    WavReader reader;
+    if (!reader.open(path)) {
         return false;
     }
+
+    sampleRate = reader.info().sampleRate;
+    std::vector<float> buf;
+    if (reader.info().sizeKnown) {
+        buf.resize(static_cast<size_t>(reader.info().numFrames));
+        if (reader.read(buf.data(), buf.size()) != buf.size()) {
+            std::cerr << "Failed to read WAV samples\n";
+            return false;
+        }
+    } else {
+        // 长度未知：分块读到 EOF
+        constexpr size_t BLOCK = 65536;
+        size_t got = 0;
+        do {
+            buf.resize(buf.size() + BLOCK);
+            got = reader.read(buf.data() + buf.size() - BLOCK, BLOCK);
+            buf.resize(buf.size() - BLOCK + got);
+        } while (got == BLOCK);
+    }
+
+    samples.resize(buf.size());
+    for (size_t i = 0; i < buf.size(); ++i) {
+        float v = std::round(buf[i]);
+        if (v > 32767.0f) v = 32767.0f;
+        if (v < -32768.0f) v = -32768.0f;
+        samples[i] = static_cast<int16_t>(v);
+    }
     return true;
-}
\ No newline at end of file
+}
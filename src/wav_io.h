@@ -1,26 +1,83 @@
 #pragma once
+#include "async_io.h"
 #include <cstdint>
 #include <string>
 #include <vector>
 
-struct WavHeader {
-    char     riff[4];        // "RIFF"
-    uint32_t chunkSize;
-    char     wave[4];        // "WAVE"
-    char     fmt[4];         // "fmt "
-    uint32_t subchunk1Size;  // 16 for PCM
-    uint16_t audioFormat;    // 1 for PCM
-    uint16_t numChannels;
-    uint32_t sampleRate;
-    uint32_t byteRate;
-    uint16_t blockAlign;
-    uint16_t bitsPerSample;
-    char     data[4];        // "data"
-    uint32_t subchunk2Size;
+// 构造单声道 16-bit PCM 的 WAV 头（字节流，小端）
+// 数据不超过 RIFF 的 4GB 上限时输出标准 44 字节头，否则输出 RF64 (ds64) 头
+std::vector<uint8_t> makeWavHeaderMono16(uint32_t sampleRate, uint64_t totalSamples);
+
+// 样本编码格式
+enum class WavSampleFormat {
+    Int16,
+    Int24,
+    Int32,
+    Float32
+};
+
+struct WavInfo {
+    uint32_t        sampleRate    = 0;
+    uint16_t        numChannels   = 0;
+    uint16_t        bitsPerSample = 0;   // 容器位宽（每声道样本占用的 bit 数）
+    uint16_t        blockAlign    = 0;
+    WavSampleFormat format        = WavSampleFormat::Int16;
+    uint64_t        dataBytes     = 0;
+    uint64_t        numFrames     = 0;   // 每声道样本数（sizeKnown 为 false 时无意义）
+    bool            rf64          = false;
+    bool            sizeKnown     = true;  // false：流式头（data 尺寸为 0 / 0xFFFFFFFF）或裸 PCM，读到 EOF 为止
 };
 
-// 这些函数现在主要给你备用，encoder/decoder 里只复用了 WavHeader 定义。
-// 如果需要简单读写 wav，也可以用它们。
+// 流式 WAV 读取器：逐 chunk 遍历（跳过 LIST/fact/JUNK 等），直接定位到 data chunk
+// 支持 RIFF/RF64、PCM/WAVE_FORMAT_EXTENSIBLE，16/24/32-bit 整数与 32-bit float
+// 多声道文件只取第 0 声道
+// path 为 "-" 时从 stdin 读取；chunk 一律顺序读过而不 seek，因此可用于管道等不可 seek 的输入
+// 底层是 AsyncReader：后台预读后面的块，解调与读盘重叠
+class WavReader {
+public:
+    bool open(const std::string& path);
+
+    // 无文件头的裸 PCM（16-bit 小端单声道），长度未知，读到 EOF 为止
+    bool openRawPcm16(const std::string& path, uint32_t sampleRate);
+
+    const WavInfo& info() const { return info_; }
+    uint64_t remainingFrames() const { return framesLeft_; }
+
+    // 读取最多 count 个样本并转换为 float，按 16-bit 满幅缩放（±32768），
+    // 与原 int16 流水线的幅度一致。返回实际读到的样本数
+    size_t read(float* out, size_t count);
+
+    // 同 read，但只等到至少一个样本：返回已到达的部分（stdin / 管道上不等凑满 count），0 表示 EOF
+    size_t readSome(float* out, size_t count);
+
+    // 定点解调用：直接读出 int16 样本。16-bit PCM 不经浮点原样取出，
+    // 其它格式四舍五入到 16 位（float 按 ±32768 满幅）并饱和
+    size_t read(int16_t* out, size_t count);
+    size_t readSome(int16_t* out, size_t count);
+
+    // 可由其它线程调用：让阻塞在 read / readSome 中的读取立即按 EOF 返回（见 AsyncReader::cancel）
+    void cancel() { in_.cancel(); }
+
+    // 定位到第 frame 个样本（每声道），之后的 read 从那里开始；
+    // 输入不可 seek（stdin、管道）时打印原因并返回 false
+    bool seekFrame(uint64_t frame);
+
+private:
+    bool openStream(const std::string& path);
+    bool parseHeader();
+    // 读最多 count 个样本的原始字节到 raw_，返回完整样本数
+    size_t readRaw(size_t count, bool partial);
+    void   convert(size_t frames, float* out) const;
+    void   convert(size_t frames, int16_t* out) const;
+
+    AsyncReader          in_;
+    WavInfo              info_;
+    uint64_t             dataOffset_ = 0;   // data chunk 第一个样本的文件偏移
+    uint64_t             framesLeft_ = 0;
+    std::vector<uint8_t> raw_;
+};
+
+// 这些函数是简单的整段读写接口，encoder/decoder 使用上面的流式接口。
 
 bool writeWavMono16(
     const std::string& path,
@@ -32,4 +89,4 @@ bool readWavMono16(
     const std::string& path,
     std::vector<int16_t>& samples,
     uint32_t& sampleRate
-);
\ No newline at end of file
+);